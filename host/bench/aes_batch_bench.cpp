@@ -0,0 +1,83 @@
+/*
+ * ============================================================================
+ * Fichier      : aes_batch_bench.cpp
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Déchiffrement CTR par lots des trames CPE : vérifie que chaque backend
+ *   (tinycrypt, bitslice, AES-NI) donne exactement le résultat de
+ *   tc_ctr_mode, puis mesure le débit de chacun.
+ *
+ *   Usage : make aes-bench
+ * ============================================================================
+ */
+
+#include "aes_batch.h"
+#include "cpe.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <tinycrypt/ctr_mode.h>
+
+#define NB_FRAMES 1000000
+#define ROUNDS 3
+
+static const uint8_t KEY[CPE_KEY_LEN] = {
+    0x00, 0x01, 0x02, 0x03,
+    0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0E, 0x0F};
+
+static const cpe::aes_backend BACKENDS[] = {
+    cpe::aes_backend::tinycrypt,
+    cpe::aes_backend::bitslice,
+    cpe::aes_backend::aesni,
+};
+
+int main()
+{
+    struct tc_aes_key_sched_struct sched;
+    tc_aes128_set_encrypt_key(&sched, KEY);
+
+    std::mt19937 rng(42);
+    std::vector<uint8_t> cipher(NB_FRAMES * CPE_PAYLOAD_LEN);
+    for (auto &b : cipher)
+        b = (uint8_t)rng();
+
+    /* Référence : tc_ctr_mode trame par trame */
+    std::vector<uint8_t> ref(cipher);
+    for (size_t i = 0; i < NB_FRAMES; ++i)
+    {
+        uint8_t *f = &ref[i * CPE_PAYLOAD_LEN];
+        uint8_t ctr[16] = {0};
+        ctr[15] = f[0];
+        tc_ctr_mode(f + 1, CPE_PLAINTEXT_LEN, f + 1, CPE_PLAINTEXT_LEN, ctr, &sched);
+    }
+
+    printf("CPE CTR par lots (%d trames, meilleur backend : %s)\n", NB_FRAMES,
+           cpe::aes_backend_name(cpe::aes_best_backend()));
+
+    std::vector<uint8_t> work(cipher.size());
+    for (cpe::aes_backend b : BACKENDS)
+    {
+        double best = 1e9;
+        for (int r = 0; r < ROUNDS; ++r)
+        {
+            work = cipher;
+            auto t0 = std::chrono::steady_clock::now();
+            cpe::ctr_crypt_frames(sched, work.data(), NB_FRAMES, CPE_PAYLOAD_LEN, b);
+            std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+            best = std::min(best, dt.count());
+        }
+        if (work != ref)
+        {
+            fprintf(stderr, "[ERROR] %s diffère de tc_ctr_mode\n", cpe::aes_backend_name(b));
+            return 1;
+        }
+        printf("%-10s %12.0f frames/s  %8.1f ns/frame  (identique à tc_ctr_mode)\n",
+               cpe::aes_backend_name(b), NB_FRAMES / best, best * 1e9 / NB_FRAMES);
+    }
+    return 0;
+}
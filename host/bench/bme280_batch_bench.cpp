@@ -0,0 +1,174 @@
+/*
+ * ============================================================================
+ * Fichier      : bme280_batch_bench.cpp
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Compensation BME280 par lots (rejeu de flux bruts à la passerelle) :
+ *   vérifie que bme280_compensate_batch donne exactement le résultat de
+ *   bme280_compensate échantillon par échantillon, sur des valeurs brutes
+ *   couvrant toute la plage des ADC et des calibrations perturbées, puis
+ *   compare les débits.
+ *
+ *   Usage : make bme280-bench
+ * ============================================================================
+ */
+
+#include "bme280_compensate.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define NB_SAMPLES 4000000
+#define NB_CALIBRATIONS 200
+#define ROUNDS 5
+
+/* Exemple de la datasheet (section 8.1) pour T / P, valeurs typiques pour H */
+static const bme280_calibration_data REFERENCE_CAL = {
+    27504, 26435, -1000,
+    36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+    75, 362, 0, 313, 50, 30};
+
+struct raw_stream
+{
+    std::vector<uint32_t> pressure;
+    std::vector<int32_t> temperature;
+    std::vector<uint16_t> humidity;
+};
+
+struct result_stream
+{
+    std::vector<int32_t> temperature;
+    std::vector<uint32_t> pressure;
+    std::vector<uint32_t> humidity;
+
+    explicit result_stream(size_t n) : temperature(n), pressure(n), humidity(n) {}
+    bme280_compensated_batch view()
+    {
+        return {temperature.data(), pressure.data(), humidity.data()};
+    }
+};
+
+static raw_stream random_stream(std::mt19937 &rng, size_t n)
+{
+    raw_stream s;
+    s.pressure.resize(n);
+    s.temperature.resize(n);
+    s.humidity.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        s.pressure[i] = rng() & 0xFFFFF; /* ADC 20 bits */
+        s.temperature[i] = (int32_t)(rng() & 0xFFFFF);
+        s.humidity[i] = (uint16_t)rng();
+    }
+    return s;
+}
+
+static bme280_calibration_data perturbed(std::mt19937 &rng)
+{
+    bme280_calibration_data c = REFERENCE_CAL;
+    auto jitter = [&](int span) { return (int)(rng() % (2 * span + 1)) - span; };
+    c.T1 += jitter(2000);
+    c.T2 += jitter(1000);
+    c.T3 += jitter(500);
+    c.P1 += jitter(3000);
+    c.P2 += jitter(1000);
+    c.P3 += jitter(500);
+    c.P4 += jitter(2000);
+    c.P5 += jitter(100);
+    c.P6 += jitter(10);
+    c.P7 += jitter(2000);
+    c.P8 += jitter(2000);
+    c.P9 += jitter(1000);
+    c.H1 = (uint8_t)rng();
+    c.H2 += jitter(50);
+    c.H3 = (uint8_t)rng();
+    c.H4 += jitter(100);
+    c.H5 += jitter(20);
+    c.H6 = (int8_t)rng();
+    return c;
+}
+
+static size_t count_mismatches(const bme280_calibration_data &cal, const raw_stream &raw,
+                               result_stream &out)
+{
+    size_t n = raw.pressure.size(), bad = 0;
+    bme280_raw_batch in = {raw.pressure.data(), raw.temperature.data(), raw.humidity.data()};
+    bme280_compensated_batch v = out.view();
+    bme280_compensate_batch(&cal, &in, &v, n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        bme280_compensated ref;
+        bme280_compensate(&cal, raw.pressure[i], raw.temperature[i], raw.humidity[i], &ref);
+        bad += ref.temperature != out.temperature[i] || ref.pressure != out.pressure[i] ||
+               ref.humidity != out.humidity[i];
+    }
+    return bad;
+}
+
+template <typename F>
+static double best_of(F fn)
+{
+    double best = 1e9;
+    for (int r = 0; r < ROUNDS; ++r)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        best = std::min(best, dt.count());
+    }
+    return best;
+}
+
+int main()
+{
+    std::mt19937 rng(42);
+
+    /* ---- Exactitude ---- */
+    size_t bad = 0;
+    for (int c = 0; c < NB_CALIBRATIONS; ++c)
+    {
+        bme280_calibration_data cal = c ? perturbed(rng) : REFERENCE_CAL;
+        raw_stream raw = random_stream(rng, 10000);
+        result_stream out(raw.pressure.size());
+        bad += count_mismatches(cal, raw, out);
+    }
+    if (bad)
+    {
+        fprintf(stderr, "[ERROR] %zu échantillons divergents\n", bad);
+        return 1;
+    }
+
+    /* ---- Débit ---- */
+    raw_stream raw = random_stream(rng, NB_SAMPLES);
+    result_stream out(NB_SAMPLES);
+    bme280_raw_batch in = {raw.pressure.data(), raw.temperature.data(), raw.humidity.data()};
+    bme280_compensated_batch v = out.view();
+    volatile uint32_t sink = 0;
+
+    double scalar = best_of([&] {
+        for (size_t i = 0; i < NB_SAMPLES; ++i)
+        {
+            bme280_compensated r;
+            bme280_compensate(&REFERENCE_CAL, raw.pressure[i], raw.temperature[i],
+                              raw.humidity[i], &r);
+            v.temperature[i] = r.temperature;
+            v.pressure[i] = r.pressure;
+            v.humidity[i] = r.humidity;
+        }
+        sink = sink + v.pressure[NB_SAMPLES - 1];
+    });
+    double batch = best_of([&] {
+        bme280_compensate_batch(&REFERENCE_CAL, &in, &v, NB_SAMPLES);
+        sink = sink + v.pressure[NB_SAMPLES - 1];
+    });
+
+    printf("BME280 compensation : %d calibrations x 10000 échantillons identiques\n",
+           NB_CALIBRATIONS);
+    printf("%-8s %8.2f ns/échantillon %10.1f M échantillons/s\n", "scalaire",
+           scalar * 1e9 / NB_SAMPLES, NB_SAMPLES / scalar / 1e6);
+    printf("%-8s %8.2f ns/échantillon %10.1f M échantillons/s  (x%.1f)\n", "lot",
+           batch * 1e9 / NB_SAMPLES, NB_SAMPLES / batch / 1e6, scalar / batch);
+    return 0;
+}
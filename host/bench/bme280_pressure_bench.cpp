@@ -0,0 +1,152 @@
+/*
+ * ============================================================================
+ * Fichier      : bme280_pressure_bench.cpp
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Compensation de pression BME280 : chemin entier 32 bits (1 Pa) contre
+ *   chemin 64 bits (Q24.8 Pa). Mesure l'erreur de chacun par rapport à la
+ *   formule en double de la datasheet sur 300 .. 1100 hPa et -40 .. 85 °C,
+ *   puis le coût (ns et cycles TSC par échantillon, sur l'hôte).
+ *
+ *   Usage : make bme280-pressure-bench
+ * ============================================================================
+ */
+
+#include "bme280_compensate.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#define NB_SAMPLES 2000000
+#define ROUNDS 5
+
+/* Calibration d'exemple des datasheets Bosch */
+static const bme280_calibration_data CAL = {
+    27504, 26435, -1000,
+    36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+    75, 362, 0, 313, 50, 30};
+#define EXAMPLE_ADC_T 519888
+#define EXAMPLE_ADC_P 415148
+
+/* Formule en virgule flottante de la datasheet (référence d'exactitude) */
+static double pressure_double(int32_t t_fine, int32_t adc_p)
+{
+    double var1 = ((double)t_fine / 2.0) - 64000.0;
+    double var2 = var1 * var1 * ((double)CAL.P6) / 32768.0;
+    var2 = var2 + var1 * ((double)CAL.P5) * 2.0;
+    var2 = (var2 / 4.0) + (((double)CAL.P4) * 65536.0);
+    var1 = (((double)CAL.P3) * var1 * var1 / 524288.0 + ((double)CAL.P2) * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * ((double)CAL.P1);
+    if (var1 == 0.0)
+        return 0;
+    double p = 1048576.0 - (double)adc_p;
+    p = (p - (var2 / 4096.0)) * 6250.0 / var1;
+    var1 = ((double)CAL.P9) * p * p / 2147483648.0;
+    var2 = p * ((double)CAL.P8) / 32768.0;
+    return p + (var1 + var2 + ((double)CAL.P7)) / 16.0;
+}
+
+static uint64_t ticks()
+{
+#if HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+struct timing
+{
+    double ns;
+    double cycles;
+};
+
+template <typename F>
+static timing best_of(F fn)
+{
+    timing best = {1e9, 1e18};
+    for (int r = 0; r < ROUNDS; ++r)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = ticks();
+        fn();
+        uint64_t c1 = ticks();
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        best.ns = std::min(best.ns, dt.count() * 1e9 / NB_SAMPLES);
+        best.cycles = std::min(best.cycles, (double)(c1 - c0) / NB_SAMPLES);
+    }
+    return best;
+}
+
+struct error_stats
+{
+    double max_pa = 0, sum_pa = 0;
+    void add(double err)
+    {
+        max_pa = std::max(max_pa, std::fabs(err));
+        sum_pa += std::fabs(err);
+    }
+};
+
+int main()
+{
+    int32_t t_fine = bme280_compensate_t_fine(&CAL, EXAMPLE_ADC_T);
+    printf("BME280 pression, exemple (t_fine %d) : double %.2f Pa, 32 bits %u Pa, 64 bits %.2f Pa\n",
+           (int)t_fine, pressure_double(t_fine, EXAMPLE_ADC_P),
+           bme280_compensate_pressure(&CAL, t_fine, EXAMPLE_ADC_P),
+           bme280_compensate_pressure_q24_8(&CAL, t_fine, EXAMPLE_ADC_P) / 256.0);
+
+    /* Échantillons bruts dont la pression de référence est dans la plage du capteur */
+    std::mt19937 rng(42);
+    std::vector<int32_t> fine(NB_SAMPLES), adc(NB_SAMPLES);
+    std::vector<double> ref(NB_SAMPLES);
+    for (size_t i = 0; i < NB_SAMPLES;)
+    {
+        int32_t adc_t = 300000 + (int32_t)(rng() % 400000);
+        int32_t adc_p = (int32_t)(rng() & 0xFFFFF);
+        int32_t tf = bme280_compensate_t_fine(&CAL, adc_t);
+        int32_t t = bme280_compensate_temperature(tf);
+        double p = pressure_double(tf, adc_p);
+        if (t < -4000 || t > 8500 || p < 30000.0 || p > 110000.0)
+            continue;
+        fine[i] = tf;
+        adc[i] = adc_p;
+        ref[i] = p;
+        ++i;
+    }
+
+    error_stats e32, e64;
+    for (size_t i = 0; i < NB_SAMPLES; ++i)
+    {
+        e32.add(bme280_compensate_pressure(&CAL, fine[i], adc[i]) - ref[i]);
+        e64.add(bme280_compensate_pressure_q24_8(&CAL, fine[i], adc[i]) / 256.0 - ref[i]);
+    }
+
+    std::vector<uint32_t> out(NB_SAMPLES);
+    timing t32 = best_of([&] {
+        for (size_t i = 0; i < NB_SAMPLES; ++i)
+            out[i] = bme280_compensate_pressure(&CAL, fine[i], adc[i]);
+    });
+    timing t64 = best_of([&] {
+        for (size_t i = 0; i < NB_SAMPLES; ++i)
+            out[i] = bme280_compensate_pressure_q24_8(&CAL, fine[i], adc[i]);
+    });
+
+    printf("%d échantillons 300 .. 1100 hPa, -40 .. 85 °C\n", NB_SAMPLES);
+    printf("%-8s %8s %14s %14s %10s\n", "chemin", "pas", "err. moy. Pa", "err. max Pa",
+           "ns/éch.");
+    printf("%-8s %8s %14.3f %14.3f %10.2f  (%.0f cycles TSC)\n", "32 bits", "1 Pa",
+           e32.sum_pa / NB_SAMPLES, e32.max_pa, t32.ns, t32.cycles);
+    printf("%-8s %8s %14.3f %14.3f %10.2f  (%.0f cycles TSC)\n", "64 bits", "1/256 Pa",
+           e64.sum_pa / NB_SAMPLES, e64.max_pa, t64.ns, t64.cycles);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * ============================================================================
+ * Fichier      : cpe_bench.c
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Benchmark natif de la construction / du parsing des trames CPE.
+ *   Compare l'ancien chemin (expansion de clé + tc_ctr_mode à chaque trame)
+ *   au pool de keystream précalculé, et vérifie que les deux produisent
+ *   exactement les mêmes octets.
+ *
+ *   Usage : make bench
+ * ============================================================================
+ */
+
+#include "cpe.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <tinycrypt/aes.h>
+#include <tinycrypt/ctr_mode.h>
+
+#define ITERATIONS 200000
+
+static const uint8_t KEY[CPE_KEY_LEN] = {
+    0x00, 0x01, 0x02, 0x03,
+    0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0E, 0x0F};
+
+static volatile uint8_t sink;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* ---------- Ancien chemin (référence) -------- */
+static void legacy_crypt(uint8_t buf[CPE_PLAINTEXT_LEN], uint8_t seq)
+{
+    struct tc_aes_key_sched_struct ks;
+    uint8_t ctr[16] = {0};
+    ctr[15] = seq;
+    tc_aes128_set_encrypt_key(&ks, KEY);
+    tc_ctr_mode(buf, CPE_PLAINTEXT_LEN, buf, CPE_PLAINTEXT_LEN, ctr, &ks);
+}
+
+static void legacy_build_measure_frame(const cpe_measure_t *m, uint8_t dev,
+                                       uint8_t seq, uint8_t out[CPE_PAYLOAD_LEN])
+{
+    uint8_t *p = out + 1;
+    p[0] = CPE_FT_MEASURE;
+    p[1] = dev;
+    p[2] = ((uint16_t)m->temperature_centi) >> 8;
+    p[3] = ((uint16_t)m->temperature_centi) & 0xFF;
+    p[4] = m->humidity_centi >> 8;
+    p[5] = m->humidity_centi & 0xFF;
+    p[6] = m->pressure_decihPa >> 8;
+    p[7] = m->pressure_decihPa & 0xFF;
+    p[8] = ((uint16_t)m->lux) >> 8;
+    p[9] = ((uint16_t)m->lux) & 0xFF;
+    p[10] = 0;
+    legacy_crypt(p, seq);
+    out[0] = seq;
+}
+
+static void legacy_parse_frame(const uint8_t f[CPE_PAYLOAD_LEN], cpe_measure_t *m)
+{
+    uint8_t buf[CPE_PLAINTEXT_LEN];
+    memcpy(buf, f + 1, CPE_PLAINTEXT_LEN);
+    legacy_crypt(buf, f[0]);
+    m->temperature_centi = (int16_t)((buf[2] << 8) | buf[3]);
+    m->humidity_centi = (uint16_t)((buf[4] << 8) | buf[5]);
+    m->pressure_decihPa = (uint16_t)((buf[6] << 8) | buf[7]);
+    m->lux = (int16_t)((buf[8] << 8) | buf[9]);
+}
+
+/* ---------- Vérification --------------------- */
+static int check_equivalence(void)
+{
+    cpe_measure_t m = {2150, 4520, 10132, 321};
+    uint8_t a[CPE_PAYLOAD_LEN], b[CPE_PAYLOAD_LEN];
+
+    for (int seq = 0; seq < 256; ++seq)
+    {
+        legacy_build_measure_frame(&m, 0x02, (uint8_t)seq, a);
+        cpe_build_measure_frame(&m, 0x02, (uint8_t)seq, b);
+        if (memcmp(a, b, CPE_PAYLOAD_LEN) != 0)
+        {
+            fprintf(stderr, "[ERROR] trame divergente pour seq=%d\n", seq);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void report(const char *name, double before, double after)
+{
+    printf("%-28s %12.0f frames/s -> %12.0f frames/s  (x%.1f)\n",
+           name, ITERATIONS / before, ITERATIONS / after, before / after);
+}
+
+int main(void)
+{
+    cpe_measure_t m = {2150, 4520, 10132, 321}, out;
+    cpe_frame_type_t ft;
+    uint8_t dev;
+    uint8_t frame[CPE_PAYLOAD_LEN];
+    double t0, legacy, pooled;
+
+    cpe_init(KEY);
+    if (check_equivalence() != 0)
+        return 1;
+
+    /* Construction : seq croissant, pool rempli en "temps libre" */
+    t0 = now_s();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        legacy_build_measure_frame(&m, 0x02, (uint8_t)i, frame);
+        sink ^= frame[1];
+    }
+    legacy = now_s() - t0;
+
+    t0 = now_s();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        cpe_build_measure_frame(&m, 0x02, (uint8_t)i, frame);
+        sink ^= frame[1];
+        if ((i % CPE_KS_POOL_LEN) == CPE_KS_POOL_LEN - 1)
+            cpe_ks_refill((uint8_t)(i + 1));
+    }
+    pooled = now_s() - t0;
+
+    /* Idem, sans compter le remplissage (coût réellement payé à l'envoi) */
+    double hot;
+    cpe_ks_refill(0);
+    t0 = now_s();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        cpe_build_measure_frame(&m, 0x02, (uint8_t)(i % CPE_KS_POOL_LEN), frame);
+        sink ^= frame[1];
+    }
+    hot = now_s() - t0;
+
+    printf("CPE keystream pool (%d blocs)\n", CPE_KS_POOL_LEN);
+    report("build (refill inclus)", legacy, pooled);
+    report("build (pool chaud)", legacy, hot);
+
+    /* Parsing d'une trame dont le keystream est dans le pool */
+    cpe_build_measure_frame(&m, 0x02, 3, frame);
+    t0 = now_s();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        legacy_parse_frame(frame, &out);
+        sink ^= (uint8_t)out.lux;
+    }
+    legacy = now_s() - t0;
+
+    t0 = now_s();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        cpe_parse_frame(frame, &ft, &dev, &out, NULL);
+        sink ^= (uint8_t)out.lux;
+    }
+    pooled = now_s() - t0;
+    report("parse (pool chaud)", legacy, pooled);
+
+    return 0;
+}
@@ -0,0 +1,305 @@
+/*
+ * ============================================================================
+ * Fichier      : cpe_proto_bench.c
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Suite de benchmarks du protocole CPE compilé nativement : coût de mise
+ *   en place de la clé, puis ns/trame et octets/s pour chaque type de
+ *   trame (build / parse, pool de keystream chaud ou manqué, batch, série,
+ *   multi-points, tag CMAC, AES-CCM). Chaque mesure est le meilleur de ROUNDS passes.
+ *
+ *   Usage : make proto-bench
+ *           cpe_proto_bench [--csv fichier]   (CSV en plus du tableau)
+ * ============================================================================
+ */
+
+#include "cpe.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define ITERATIONS 200000
+#define KEY_ITERATIONS 20000
+#define ROUNDS 5
+#define BATCH_N 10
+
+static const uint8_t KEY[CPE_KEY_LEN] = {
+    0x00, 0x01, 0x02, 0x03,
+    0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0E, 0x0F};
+
+static volatile uint8_t sink;
+static FILE *csv;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* bytes : octets de trame traités par opération (0 si sans objet) */
+static void report(const char *name, size_t bytes, long iters, double best)
+{
+    double ns = best * 1e9 / iters;
+    double bps = bytes ? bytes * 1e9 / ns : 0;
+
+    printf("%-26s %4zu o %10.1f ns/op %12.0f op/s %8.2f Mo/s\n", name, bytes, ns,
+           1e9 / ns, bps / 1e6);
+    if (csv)
+        fprintf(csv, "%s,%d,%zu,%ld,%.2f,%.0f,%.0f\n", name, CPE_KS_POOL_LEN, bytes,
+                iters, ns, 1e9 / ns, bps);
+}
+
+/* Exécute body iters fois, ROUNDS passes, et rapporte la meilleure.
+ * i est l'indice d'itération visible dans body.                     */
+#define BENCH(name, bytes, iters, body)                  \
+    do                                                   \
+    {                                                    \
+        double best_ = 1e9;                              \
+        for (int r_ = 0; r_ < ROUNDS; ++r_)              \
+        {                                                \
+            double t0_ = now_s();                        \
+            for (long i = 0; i < (iters); ++i)           \
+            {                                            \
+                body;                                    \
+            }                                            \
+            double dt_ = now_s() - t0_;                  \
+            if (dt_ < best_)                             \
+                best_ = dt_;                             \
+        }                                                \
+        report(name, bytes, iters, best_);               \
+    } while (0)
+
+/* seq dont le keystream n'est jamais dans le pool rempli depuis 0 */
+static inline uint8_t miss_seq(long i)
+{
+    return (uint8_t)(CPE_KS_POOL_LEN + i % (256 - CPE_KS_POOL_LEN));
+}
+
+int main(int argc, char **argv)
+{
+    static cpe_ctx_t ctx, tmp;
+    cpe_measure_t m = {2150, 4520, 10132, 321}, out;
+    cpe_sample_t samples[BATCH_N], decoded[CPE_SERIES_MAX_SAMPLES];
+    cpe_frame_type_t ft;
+    cpe_view_t view;
+    uint8_t dev, ctrl;
+    uint8_t frame[CPE_AUTH_PAYLOAD_LEN], work[CPE_AUTH_PAYLOAD_LEN];
+    uint8_t batch[CPE_BATCH_MAX_LEN], series[CPE_BATCH_MAX_LEN];
+
+    if (argc == 3 && strcmp(argv[1], "--csv") == 0)
+    {
+        if (!(csv = fopen(argv[2], "w")))
+        {
+            perror(argv[2]);
+            return 1;
+        }
+        fprintf(csv, "name,ks_pool_len,bytes,iterations,ns_per_op,ops_per_s,bytes_per_s\n");
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [--csv fichier]\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = 0; i < BATCH_N; ++i)
+    {
+        samples[i].t_ms = 1000 * i;
+        samples[i].m = m;
+        samples[i].m.temperature_centi += i % 3;
+        samples[i].m.lux += 7 * i;
+    }
+
+    printf("CPE protocole : pool %d blocs, meilleur de %d passes\n", CPE_KS_POOL_LEN,
+           ROUNDS);
+
+    /* ---- Clé ---- */
+    BENCH("key_setup", 0, KEY_ITERATIONS, cpe_ctx_init(&tmp, KEY); sink ^= tmp.pool[0].valid);
+    cpe_ctx_init(&ctx, KEY);
+    /* pool vidé à chaque tour : CPE_KS_POOL_LEN blocs AES par appel */
+    BENCH("ks_refill_pool", CPE_KS_POOL_LEN * CPE_PLAINTEXT_LEN, KEY_ITERATIONS,
+          memset(ctx.pool, 0, sizeof(ctx.pool));
+          sink ^= (uint8_t)cpe_ctx_ks_refill(&ctx, 0));
+
+    /* ---- MEASURE / CONTROL / PROFILE (12 octets) ---- */
+    BENCH("build_measure_hot", CPE_PAYLOAD_LEN, ITERATIONS,
+          cpe_ctx_build_measure_frame(&ctx, &m, 2, (uint8_t)(i % CPE_KS_POOL_LEN), frame);
+          sink ^= frame[1]);
+    BENCH("build_measure_miss", CPE_PAYLOAD_LEN, ITERATIONS,
+          cpe_ctx_build_measure_frame(&ctx, &m, 2, miss_seq(i), frame); sink ^= frame[1]);
+    BENCH("build_control_hot", CPE_PAYLOAD_LEN, ITERATIONS,
+          cpe_ctx_build_control_frame(&ctx, 0x1B, 2, (uint8_t)(i % CPE_KS_POOL_LEN), frame);
+          sink ^= frame[1]);
+    BENCH("build_profile_hot", CPE_PAYLOAD_LEN, ITERATIONS,
+          cpe_ctx_build_profile_frame(&ctx, CPE_PROFILE_INDOOR, 2,
+                                      (uint8_t)(i % CPE_KS_POOL_LEN), frame);
+          sink ^= frame[1]);
+
+    cpe_ctx_build_measure_frame(&ctx, &m, 2, 3, frame);
+    BENCH("parse_measure_hot", CPE_PAYLOAD_LEN, ITERATIONS,
+          cpe_ctx_parse_frame(&ctx, frame, &ft, &dev, &out, NULL); sink ^= (uint8_t)out.lux);
+    BENCH("open_measure_hot", CPE_PAYLOAD_LEN, ITERATIONS,
+          memcpy(work, frame, CPE_PAYLOAD_LEN);
+          cpe_ctx_open_frame(&ctx, work, CPE_PAYLOAD_LEN, &view);
+          sink ^= (uint8_t)cpe_view_lux(&view));
+    cpe_ctx_build_measure_frame(&ctx, &m, 2, miss_seq(0), frame);
+    BENCH("parse_measure_miss", CPE_PAYLOAD_LEN, ITERATIONS,
+          cpe_ctx_parse_frame(&ctx, frame, &ft, &dev, &out, NULL); sink ^= (uint8_t)out.lux);
+    cpe_ctx_build_control_frame(&ctx, 0x1B, 2, 4, frame);
+    BENCH("parse_control_hot", CPE_PAYLOAD_LEN, ITERATIONS,
+          cpe_ctx_parse_frame(&ctx, frame, &ft, &dev, NULL, &ctrl); sink ^= ctrl);
+
+    /* ---- Authentification (12 + tag) ---- */
+    cpe_ctx_build_measure_frame(&ctx, &m, 2, 5, frame);
+    BENCH("auth_seal", CPE_AUTH_PAYLOAD_LEN, ITERATIONS,
+          sink ^= (uint8_t)cpe_ctx_auth_seal(&ctx, frame, CPE_PAYLOAD_LEN, sizeof(frame)));
+    BENCH("auth_check", CPE_AUTH_PAYLOAD_LEN, ITERATIONS,
+          sink ^= (uint8_t)cpe_ctx_auth_check(&ctx, frame, CPE_AUTH_PAYLOAD_LEN));
+
+    /* MAC incrémental sur 1 Ko reçu par fragments de 64 octets */
+    static uint8_t dump[1024];
+    cpe_mac_t mac;
+    BENCH("mac_stream_1k_64", sizeof(dump), ITERATIONS / 100,
+          cpe_ctx_mac_begin(&ctx, &mac);
+          for (size_t off = 0; off < sizeof(dump); off += 64)
+              cpe_mac_update(&mac, dump + off, 64);
+          cpe_mac_final(&mac, work, CPE_AUTH_TAG_LEN); sink ^= work[0]);
+
+    /* ---- AEAD (AES-CCM, 12 + tag) ---- */
+    /* RFC 3610, Packet Vector #1 (M = 8, L = 2) : CCM de tinycrypt tel
+     * que l'utilise cpe.c                                              */
+    {
+        static const uint8_t rfc_key[16] = {
+            0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+            0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF};
+        static const uint8_t rfc_nonce[13] = {
+            0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5};
+        static const uint8_t rfc_out[23 + 8] = {
+            0x58, 0x8C, 0x97, 0x9A, 0x61, 0xC6, 0x63, 0xD2, 0xF0, 0x66, 0xD0, 0xC2,
+            0xC0, 0xF9, 0x89, 0x80, 0x6D, 0x5F, 0x6B, 0x61, 0xDA, 0xC3, 0x84,
+            0x17, 0xE8, 0xD1, 0x2C, 0xFD, 0xF9, 0x26, 0xE0};
+        struct tc_aes_key_sched_struct rfc_sched;
+        struct tc_ccm_mode_struct ccm;
+        uint8_t nonce[13], hdr[8], pt[23], ct[23 + 8], back[23];
+
+        for (int i = 0; i < 8; ++i)
+            hdr[i] = (uint8_t)i;
+        for (int i = 0; i < 23; ++i)
+            pt[i] = (uint8_t)(8 + i);
+        memcpy(nonce, rfc_nonce, sizeof(nonce));
+        tc_aes128_set_encrypt_key(&rfc_sched, rfc_key);
+        tc_ccm_config(&ccm, &rfc_sched, nonce, sizeof(nonce), 8);
+        if (tc_ccm_generation_encryption(ct, sizeof(ct), hdr, sizeof(hdr), pt, sizeof(pt),
+                                         &ccm) != TC_CRYPTO_SUCCESS ||
+            memcmp(ct, rfc_out, sizeof(ct)) != 0 ||
+            tc_ccm_decryption_verification(back, sizeof(back), hdr, sizeof(hdr), ct,
+                                           sizeof(ct), &ccm) != TC_CRYPTO_SUCCESS ||
+            memcmp(back, pt, sizeof(pt)) != 0)
+        {
+            fprintf(stderr, "[ERROR] AES-CCM : vecteur RFC 3610 #1\n");
+            return 1;
+        }
+    }
+
+    /* Aller-retour d'une trame CPE, puis rejet de toute trame altérée
+     * (seq, chiffré, tag)                                              */
+    cpe_ctx_ccm_build_measure_frame(&ctx, &m, 2, 5, frame);
+    memcpy(work, frame, CPE_CCM_PAYLOAD_LEN);
+    if (cpe_ctx_ccm_open_frame(&ctx, work, CPE_CCM_PAYLOAD_LEN, &view) != 0 ||
+        cpe_view_device_id(&view) != 2 || cpe_view_lux(&view) != m.lux)
+    {
+        fprintf(stderr, "[ERROR] AES-CCM : aller-retour\n");
+        return 1;
+    }
+    static const size_t tampered[] = {0, 1, CPE_PAYLOAD_LEN - 1, CPE_CCM_PAYLOAD_LEN - 1};
+    for (size_t k = 0; k < sizeof(tampered) / sizeof(tampered[0]); ++k)
+    {
+        memcpy(work, frame, CPE_CCM_PAYLOAD_LEN);
+        work[tampered[k]] ^= 0x01;
+        if (cpe_ctx_ccm_open_frame(&ctx, work, CPE_CCM_PAYLOAD_LEN, &view) == 0)
+        {
+            fprintf(stderr, "[ERROR] AES-CCM : trame altérée (octet %zu) acceptée\n",
+                    tampered[k]);
+            return 1;
+        }
+    }
+
+    BENCH("ccm_build_measure", CPE_CCM_PAYLOAD_LEN, ITERATIONS,
+          cpe_ctx_ccm_build_measure_frame(&ctx, &m, 2, (uint8_t)i, frame); sink ^= frame[1]);
+    cpe_ctx_ccm_build_measure_frame(&ctx, &m, 2, 5, frame);
+    BENCH("ccm_open_measure", CPE_CCM_PAYLOAD_LEN, ITERATIONS,
+          memcpy(work, frame, CPE_CCM_PAYLOAD_LEN);
+          sink ^= (uint8_t)cpe_ctx_ccm_open_frame(&ctx, work, CPE_CCM_PAYLOAD_LEN, &view));
+
+    /* ---- Trames longues ---- */
+    /* Flux CTR de plus de 256 blocs : le compteur ne doit pas déborder sur
+     * le seq, le keystream de seq 5 au-delà du bloc 255 ne doit pas être
+     * celui de seq 6                                                      */
+    static uint8_t ks_a[257 * 16 + 16], ks_b[257 * 16 + 16];
+    cpe_stream_t st;
+    memset(ks_a, 0, sizeof(ks_a));
+    memset(ks_b, 0, sizeof(ks_b));
+    cpe_ctx_stream_begin(&ctx, &st, 5);
+    cpe_stream_crypt(&st, ks_a, sizeof(ks_a));
+    cpe_ctx_stream_begin(&ctx, &st, 6);
+    cpe_stream_crypt(&st, ks_b, sizeof(ks_b));
+    if (memcmp(ks_a + 256 * 16, ks_b, 16) == 0 || memcmp(ks_a + 16, ks_b, 16) == 0)
+    {
+        fprintf(stderr, "[ERROR] keystream partagé entre deux seq (flux > 4 Ko)\n");
+        return 1;
+    }
+
+    int blen = cpe_ctx_build_measure_batch(&ctx, samples, BATCH_N, 2, 6, batch, sizeof(batch));
+    int slen = cpe_ctx_build_series_frame(&ctx, samples, BATCH_N, 2, 7, series, sizeof(series));
+    if (blen < 0 || slen < 0)
+    {
+        fprintf(stderr, "[ERROR] construction batch / série\n");
+        return 1;
+    }
+    BENCH("build_batch_10", (size_t)blen, ITERATIONS / 10,
+          cpe_ctx_build_measure_batch(&ctx, samples, BATCH_N, 2, (uint8_t)i, batch,
+                                      sizeof(batch));
+          sink ^= batch[1]);
+    BENCH("parse_batch_10", (size_t)blen, ITERATIONS / 10,
+          sink ^= (uint8_t)cpe_ctx_parse_measure_batch(&ctx, batch, (size_t)blen, &dev,
+                                                       decoded, CPE_SERIES_MAX_SAMPLES));
+    BENCH("build_series_10", (size_t)slen, ITERATIONS / 10,
+          cpe_ctx_build_series_frame(&ctx, samples, BATCH_N, 2, (uint8_t)i, series,
+                                     sizeof(series));
+          sink ^= series[1]);
+    cpe_ctx_build_series_frame(&ctx, samples, BATCH_N, 2, 7, series, sizeof(series));
+    BENCH("parse_series_10", (size_t)slen, ITERATIONS / 10,
+          sink ^= (uint8_t)cpe_ctx_parse_measure_batch(&ctx, series, (size_t)slen, &dev,
+                                                       decoded, CPE_SERIES_MAX_SAMPLES));
+
+    /* ---- Multi-points (3 capteurs) ---- */
+    cpe_point_t points[3], points_out[CPE_MULTI_MAX_POINTS];
+    for (int i = 0; i < 3; ++i)
+    {
+        points[i].point = cpe_point_pack((uint8_t)(i < 2 ? i : CPE_POINT_NONE), (uint8_t)i);
+        points[i].m = samples[i].m;
+    }
+    int mlen = cpe_ctx_build_multi_frame(&ctx, points, 3, 2, 8, batch, sizeof(batch));
+    if (mlen != CPE_MULTI_LEN(3) ||
+        cpe_ctx_parse_multi_frame(&ctx, batch, (size_t)mlen, &dev, points_out,
+                                  CPE_MULTI_MAX_POINTS) != 3 ||
+        memcmp(&points_out[2].m, &points[2].m, sizeof(cpe_measure_t)) != 0 ||
+        points_out[2].point != points[2].point)
+    {
+        fprintf(stderr, "[ERROR] aller-retour multi-points\n");
+        return 1;
+    }
+    BENCH("build_multi_3", (size_t)mlen, ITERATIONS / 10,
+          cpe_ctx_build_multi_frame(&ctx, points, 3, 2, (uint8_t)i, batch, sizeof(batch));
+          sink ^= batch[1]);
+    cpe_ctx_build_multi_frame(&ctx, points, 3, 2, 8, batch, sizeof(batch));
+    BENCH("parse_multi_3", (size_t)mlen, ITERATIONS / 10,
+          sink ^= (uint8_t)cpe_ctx_parse_multi_frame(&ctx, batch, (size_t)mlen, &dev,
+                                                     points_out, CPE_MULTI_MAX_POINTS));
+
+    if (csv)
+        fclose(csv);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * ============================================================================
+ * Fichier      : crypto_bench_host.c
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Exécute sur l'hôte les micro-benchmarks tinycrypt de crypto_bench.c,
+ *   les mêmes que le mode CRYPTO_BENCH du firmware, et affiche µs / ns par
+ *   appel et le débit.
+ *
+ *   Usage : make crypto-bench
+ *           crypto_bench [iterations]
+ * ============================================================================
+ */
+
+#include "crypto_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 20000
+
+static uint64_t clock_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static void report(const crypto_bench_result_t *r, void *user)
+{
+    double us = (double)r->elapsed_us / r->iterations;
+    (void)user;
+
+    printf("%-26s %4zu o %10.3f µs/appel %10.1f ns/appel %8.2f Mo/s\n", r->name, r->bytes,
+           us, us * 1000, us > 0 ? r->bytes / us : 0);
+}
+
+int main(int argc, char **argv)
+{
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0)
+    {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 2;
+    }
+    printf("tinycrypt : %ld appels par primitive\n", iterations);
+    return crypto_bench_run(clock_us, report, NULL, (uint32_t)iterations) > 0 ? 0 : 1;
+}
@@ -0,0 +1,485 @@
+/*
+ * ============================================================================
+ * Fichier      : driver_bench.cpp
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Drivers bme280, tsl256x, ssd1306 et sensor_registry, sans modification,
+ *   sur les périphériques simulés de host/sim (bus I2C à 100 kHz, temps
+ *   virtuel). Vérifie :
+ *   - la calibration lue par le driver (contre la lecture du simulateur) et
+ *     le cache en flash (moins de transferts au second démarrage, ignoré
+ *     pour un composant remplacé) ;
+ *   - les valeurs compensées contre l'environnement simulé, en mode forcé,
+ *     en mode normal et avec des conversions plus lentes que le typique ;
+ *   - l'application des profils (config écrit capteur en sommeil) ;
+ *   - la GDDRAM de l'OLED après update_screen() contre la police ;
+ *   - la file I2C avec son moteur en fibre : une lecture prioritaire
+ *     soumise pendant update_screen() passe avant les chunks restants ;
+ *   - l'échantillonnage groupé de sensor_registry.
+ *   Puis mesure, pour les chemins chauds, le coût CPU sur l'hôte (ns/op)
+ *   et le temps bus / temps virtuel par opération.
+ *
+ *   Usage : make driver-bench
+ * ============================================================================
+ */
+
+#include "MicroBit.h"
+#include "fake_bme280.h"
+#include "fake_ssd1306.h"
+#include "fake_tsl256x.h"
+#include "sim_bus.h"
+
+#include "bme280.h"
+#include "i2c_queue.h"
+#include "sensor_registry.h"
+#include "ssd1306.h"
+#include "tsl256x.h"
+
+#include "font.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#define ROW(x) VERTICAL_REV(x)
+DECLARE_FONT(bench_font);
+
+static MicroBit uBit;
+static MicroBitI2C i2c(I2C_SDA0, I2C_SCL0);
+static i2c_queue i2cQueue(&i2c);
+
+static sim::fake_bme280 env0, env1;
+static sim::fake_tsl256x light0, light1;
+static sim::fake_ssd1306 oled_dev;
+
+static int failures = 0;
+
+#define CHECK(cond, ...)                  \
+    do                                    \
+    {                                     \
+        if (!(cond))                      \
+        {                                 \
+            printf("  ÉCHEC : ");         \
+            printf(__VA_ARGS__);          \
+            printf("\n");                 \
+            failures++;                   \
+        }                                 \
+    } while (0)
+
+/* ---------- Mesures ------------------ */
+/* Bus et horloge virtuelle entre deux instants */
+struct bus_span
+{
+    sim::bus_stats start;
+    uint64_t t0;
+
+    bus_span() : start(sim::i2c_bus().stats()), t0(sim::now_us()) {}
+    uint64_t transfers() const { return sim::i2c_bus().stats().transfers - start.transfers; }
+    uint64_t bytes() const { return sim::i2c_bus().stats().bytes - start.bytes; }
+    uint64_t busy_us() const { return sim::i2c_bus().stats().busy_us - start.busy_us; }
+    uint64_t elapsed_us() const { return sim::now_us() - t0; }
+};
+
+template <typename F>
+static void measure(const char *name, int n, F fn)
+{
+    bus_span span;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++)
+        fn();
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+    printf("%-26s %10.0f %10.1f %10.1f %12.1f\n", name, dt.count() * 1e9 / n,
+           (double)span.transfers() / n, (double)span.busy_us() / n,
+           (double)span.elapsed_us() / n);
+}
+
+/* ---------- BME280 ------------------- */
+static bool same_calibration(const bme280_calibration_data &a, const bme280_calibration_data &b)
+{
+    return a.T1 == b.T1 && a.T2 == b.T2 && a.T3 == b.T3 && a.P1 == b.P1 && a.P2 == b.P2 &&
+           a.P3 == b.P3 && a.P4 == b.P4 && a.P5 == b.P5 && a.P6 == b.P6 && a.P7 == b.P7 &&
+           a.P8 == b.P8 && a.P9 == b.P9 && a.H1 == b.H1 && a.H2 == b.H2 && a.H3 == b.H3 &&
+           a.H4 == b.H4 && a.H5 == b.H5 && a.H6 == b.H6;
+}
+
+struct environment
+{
+    double temp_c, press_pa, hum_pct;
+};
+
+static void check_values(const char *what, const bme280_compensated &v, const environment &e)
+{
+    printf("  %-22s %7.2f °C %9u Pa %6.2f %%rH\n", what, v.temperature / 100.0, v.pressure,
+           v.humidity / 100.0);
+    CHECK(fabs(v.temperature - e.temp_c * 100) <= 1, "température %d, attendu %.2f",
+          (int)v.temperature, e.temp_c);
+    CHECK(fabs(v.pressure - e.press_pa) <= 1, "pression %u, attendu %.0f", v.pressure, e.press_pa);
+    CHECK(fabs(v.humidity - e.hum_pct * 100) <= 10, "humidité %u, attendu %.2f", v.humidity,
+          e.hum_pct);
+}
+
+static void bench_bme280()
+{
+    printf("BME280 (0x%02X)\n", BME280_ADDR);
+
+    bus_span cold;
+    bme280 *first = new bme280(&uBit, &i2cQueue, BME280_ADDR, BME280_OS_x16, BME280_OS_x16,
+                               BME280_OS_x16, BME280_SLEEP);
+    printf("  premier démarrage : %llu transferts, %llu octets\n",
+           (unsigned long long)cold.transfers(), (unsigned long long)cold.bytes());
+    CHECK(same_calibration(*first->calibration(), env0.calibration()),
+          "calibration du driver différente de celle du composant");
+    delete first;
+
+    bus_span warm;
+    bme280 *sensor = new bme280(&uBit, &i2cQueue, BME280_ADDR, BME280_OS_x16, BME280_OS_x16,
+                                BME280_OS_x16, BME280_SLEEP);
+    printf("  démarrage suivant : %llu transferts, %llu octets (calibration en flash)\n",
+           (unsigned long long)warm.transfers(), (unsigned long long)warm.bytes());
+    CHECK(warm.transfers() < cold.transfers(), "le cache de calibration n'évite aucun transfert");
+    CHECK(same_calibration(*sensor->calibration(), env0.calibration()),
+          "calibration relue de la flash différente de celle du composant");
+
+    /* Composant remplacé à la même adresse : le cache ne doit pas servir */
+    {
+        sim::bme280_cal_blob blob = sim::bme280_datasheet_blob;
+        blob.tp[0] ^= 0x5A; /* T1 */
+        blob.tp[8] ^= 0x21; /* P2 */
+        sim::fake_bme280 other(blob);
+        sim::i2c_bus().attach(BME280_ADDR, &other);
+        bme280 swapped(&uBit, &i2cQueue, BME280_ADDR, BME280_OS_x16, BME280_OS_x16,
+                       BME280_OS_x16, BME280_SLEEP);
+        CHECK(same_calibration(*swapped.calibration(), other.calibration()),
+              "calibration en flash d'un autre composant utilisée");
+        sim::i2c_bus().attach(BME280_ADDR, &env0);
+        bme280 back(&uBit, &i2cQueue, BME280_ADDR, BME280_OS_x16, BME280_OS_x16,
+                    BME280_OS_x16, BME280_SLEEP);
+        CHECK(same_calibration(*back.calibration(), env0.calibration()),
+              "calibration non relue au retour du composant d'origine");
+    }
+
+    /* Mode forcé, plusieurs environnements */
+    static const environment envs[] = {
+        {21.5, 101325, 45.0},
+        {-10.0, 90000, 20.0},
+        {40.25, 108000, 80.5},
+    };
+    for (const environment &e : envs)
+    {
+        bme280_compensated v = {};
+        env0.set_environment(e.temp_c, e.press_pa, e.hum_pct);
+        CHECK(sensor->sensor_read_compensated(&v) == 0, "lecture forcée");
+        check_values("forcé x16", v, e);
+    }
+
+    /* Conversion 20 % plus lente que le typique, au-delà du maximum de la
+     * datasheet : le driver doit l'attendre en interrogeant status        */
+    env0.set_environment(envs[0].temp_c, envs[0].press_pa, envs[0].hum_pct);
+    env0.set_timing_scale(1.2);
+    {
+        bme280_compensated v = {};
+        bus_span span;
+        CHECK(sensor->sensor_read_compensated(&v) == 0, "lecture forcée, conversion lente");
+        check_values("forcé, conversion lente", v, envs[0]);
+        printf("  conversion lente : %u µs, lecture en %llu µs virtuelles, %llu transferts\n",
+               env0.conversion_time_us(), (unsigned long long)span.elapsed_us(),
+               (unsigned long long)span.transfers());
+    }
+
+    /* Conversion deux fois plus lente : abandon dans le budget d'attente */
+    env0.set_timing_scale(2.0);
+    {
+        bme280_compensated v = {};
+        bus_span span;
+        uint64_t bound_ms = (sensor->measurement_time_us() + 999) / 1000 +
+                            BME280_POLL_BUDGET_MS + BME280_POLL_PERIOD_MS;
+        CHECK(sensor->sensor_read_compensated(&v) < 0, "conversion bloquée acceptée");
+        CHECK(span.elapsed_us() <= bound_ms * 1000, "abandon après %llu µs (borne %llu ms)",
+              (unsigned long long)span.elapsed_us(), (unsigned long long)bound_ms);
+        uBit.sleep(env0.conversion_time_us() / 1000);
+    }
+    env0.set_timing_scale(1.0);
+
+    /* Profils : config doit être pris même en venant du mode normal */
+    CHECK(sensor->set_profile(BME280_PROFILE_INDOOR) == 0, "profil intérieur");
+    CHECK(env0.reg(0xF5) == BME280_CONFIG(BME280_SB_05ms, BME280_FILT_16),
+          "config 0x%02X après le profil intérieur", env0.reg(0xF5));
+    CHECK(sensor->set_profile(BME280_PROFILE_FAST_RESPONSE) == 0, "profil réponse rapide");
+    CHECK(env0.reg(0xF5) == BME280_CONFIG(BME280_SB_05ms, BME280_FILT_2),
+          "config 0x%02X après le profil réponse rapide", env0.reg(0xF5));
+    CHECK(env0.config_ignored() == 0, "%u écritures de config ignorées (mode normal)",
+          env0.config_ignored());
+    uBit.sleep(20);
+    {
+        bme280_compensated v = {};
+        CHECK(sensor->sensor_read_compensated(&v) == 0, "lecture en mode normal");
+        check_values("normal (réponse rapide)", v, envs[0]);
+    }
+    CHECK(sensor->set_profile(BME280_PROFILE_WEATHER) == 0, "profil météo");
+    CHECK((env0.reg(0xF4) & 0x03) == BME280_SLEEP, "capteur pas en sommeil après le profil météo");
+    delete sensor;
+}
+
+/* ---------- TSL256x ------------------ */
+static void bench_tsl256x()
+{
+    printf("TSL256x (0x%02X)\n", TSL256x_ADDR_LOW);
+
+    /* Mise sous tension lente : la sonde doit relire control jusqu'à 0x03 */
+    light0.set_channels(1000, 200);
+    light0.set_power_up_us(3000);
+    bus_span boot;
+    tsl256x *sensor = new tsl256x(&uBit, &i2cQueue, TSL256x_ADDR_LOW);
+    printf("  construction : %llu µs virtuelles, %llu transferts, %u lectures de control\n",
+           (unsigned long long)boot.elapsed_us(), (unsigned long long)boot.transfers(),
+           light0.control_reads());
+    CHECK(light0.powered(), "capteur pas sous tension");
+    CHECK(light0.control_reads() > 1, "control lu une seule fois malgré le délai");
+    CHECK(boot.elapsed_us() < 20000, "construction en %llu µs",
+          (unsigned long long)boot.elapsed_us());
+    CHECK(uBit.display.scrolled == 0, "erreur affichée par le driver");
+    CHECK(light0.reg(0x01) == (TSL256x_LOW_GAIN | TSL256x_INTEGRATION_100ms),
+          "timing 0x%02X", light0.reg(0x01));
+
+    /* La configuration relance l'intégration (101 ms) : pas de résultat avant */
+    uint16_t comb = 0, ir = 0;
+    uint32_t lux = 0;
+    uBit.sleep(2);
+    CHECK(sensor->sensor_read(&comb, &ir, &lux) == MICROBIT_BUSY,
+          "lecture acceptée avant la fin de l'intégration (%u lux)", lux);
+    uBit.sleep(101);
+    CHECK(sensor->sensor_read(&comb, &ir, &lux) == 0, "lecture");
+    printf("  canal 0 %u, canal 1 %u, %u lux\n", comb, ir, lux);
+    CHECK(comb == 1000 && ir == 200, "canaux %u / %u, attendu 1000 / 200", comb, ir);
+    CHECK(lux > 0, "éclairement nul");
+    delete sensor;
+
+    /* Autre composant à l'adresse : numéro de pièce refusé */
+    sim::fake_tsl256x other(0xA0);
+    sim::i2c_bus().attach(TSL256x_ADDR_HIGH, &other);
+    sensor = new tsl256x(&uBit, &i2cQueue, TSL256x_ADDR_HIGH);
+    CHECK(sensor->probe_sensor() == 0, "numéro de pièce 0x%02X accepté", other.reg(0x0A));
+    CHECK(sensor->read_id() < 0, "identifiant lu sur un capteur refusé");
+    delete sensor;
+    sim::i2c_bus().detach(TSL256x_ADDR_HIGH);
+    uBit.display.scrolled = 0;
+}
+
+/* ---------- SSD1306 ------------------ */
+static void expected_text(uint8_t *ram, uint8_t line, uint8_t col, const char *text)
+{
+    for (; *text != '\0'; text++, col++)
+    {
+        uint8_t c = (uint8_t)*text;
+        uint8_t tile = (c > FIRST_FONT_CHAR) ? (c - FIRST_FONT_CHAR) : 0;
+        memcpy(ram + line * SSD130x_NB_COL + col * 8, &bench_font[tile], 8);
+    }
+}
+
+static ssd1306 *bench_ssd1306(MicroBitPin *reset)
+{
+    printf("SSD1306 (0x%02X)\n", SSD130x_ADDR);
+
+    ssd1306 *oled = new ssd1306(&uBit, &i2cQueue, reset);
+    CHECK(oled_dev.display_on(), "écran éteint après l'initialisation");
+    CHECK(oled_dev.addressing_mode() == SSD130x_ADDR_TYPE_HORIZONTAL, "mode d'adressage %u",
+          oled_dev.addressing_mode());
+    /* Constat, pas un échec : set_mux_ratio() envoie 0x22 (deux arguments)
+     * au lieu de 0xA8, la commande 0xD3 suivante sert d'argument          */
+    printf("  mux %u, décalage reçu %u (0xD3 envoyé avec 4), contraste 0x%02X\n",
+           oled_dev.mux_ratio() + 1, oled_dev.display_offset(), oled_dev.contrast());
+
+    static uint8_t expected[GDDRAM_SIZE];
+    memset(expected, 0, sizeof(expected));
+    oled->display_line(0, 0, "CPE sim");
+    oled->display_line(3, 2, "T 21.50C");
+    oled->display_line(7, 10, "P 1013");
+    expected_text(expected, 0, 0, "CPE sim");
+    expected_text(expected, 3, 2, "T 21.50C");
+    expected_text(expected, 7, 10, "P 1013");
+
+    bus_span span;
+    CHECK(oled->update_screen() == MICROBIT_OK, "update_screen");
+    printf("  update_screen : %llu transferts, %llu octets, %llu µs de bus\n",
+           (unsigned long long)span.transfers(), (unsigned long long)span.bytes(),
+           (unsigned long long)span.busy_us());
+    CHECK(memcmp(oled_dev.gddram(), expected, GDDRAM_SIZE) == 0,
+          "GDDRAM différente du framebuffer attendu");
+
+    /* Seconde image : le pointeur GDDRAM doit être revenu en page 0, colonne 0 */
+    oled->display_line(7, 10, "P 1014");
+    expected_text(expected, 7, 10, "P 1014");
+    CHECK(oled->update_screen() == MICROBIT_OK, "update_screen");
+    CHECK(memcmp(oled_dev.gddram(), expected, GDDRAM_SIZE) == 0,
+          "GDDRAM décalée après la seconde image");
+    return oled;
+}
+
+/* ---------- File I2C (moteur) ------- */
+/* Lecture capteur soumise par une autre fibre pendant update_screen() */
+struct sensor_fiber_probe
+{
+    i2c_queue *queue;
+    unsigned oled_at_submit; /* octets GDDRAM reçus par l'écran */
+    unsigned oled_at_done;
+    int status;
+    uint8_t part_id;
+    bool done;
+};
+
+static void sensor_fiber(void *param)
+{
+    sensor_fiber_probe *p = (sensor_fiber_probe *)param;
+    char reg = TSL256x_CMD(part_id);
+
+    uBit.sleep(10); /* quelques chunks après le début de l'image */
+    p->oled_at_submit = oled_dev.data_bytes();
+    p->status = p->queue->write_read(TSL256x_ADDR_LOW, &reg, 1, (char *)&p->part_id, 1,
+                                     I2C_PRIO_HIGH);
+    p->oled_at_done = oled_dev.data_bytes();
+    p->done = true;
+}
+
+static void bench_i2c_queue(MicroBitPin *reset)
+{
+    printf("i2c_queue (moteur en fibre)\n");
+
+    /* File et écran propres au test : la file globale reste synchrone */
+    i2c_queue queue(&i2c);
+    ssd1306 oled(&uBit, &queue, reset);
+    oled.display_line(2, 0, "moteur I2C");
+    static uint8_t expected[GDDRAM_SIZE];
+    memset(expected, 0, sizeof(expected));
+    expected_text(expected, 2, 0, "moteur I2C");
+
+    sim::scheduler_start();
+    CHECK(queue.start() == 0, "démarrage du moteur");
+
+    sensor_fiber_probe probe = {&queue, 0, 0, MICROBIT_BUSY, 0, false};
+    CHECK(create_fiber(sensor_fiber, &probe) != NULL, "création de la fibre capteur");
+
+    unsigned oled_start = oled_dev.data_bytes();
+    bus_span span;
+    CHECK(oled.update_screen() == MICROBIT_OK, "update_screen");
+    unsigned oled_end = oled_dev.data_bytes();
+    printf("  update_screen : %llu transferts en %llu µs virtuelles\n",
+           (unsigned long long)span.transfers(), (unsigned long long)span.elapsed_us());
+
+    /* Priorité : la lecture passe avant les chunks restants, après au plus
+     * le chunk en cours ; reprise : l'image complète arrive ensuite       */
+    CHECK(probe.done && probe.status == MICROBIT_OK, "lecture capteur : %d", probe.status);
+    CHECK(probe.part_id == light0.reg(0x0A), "identifiant 0x%02X", probe.part_id);
+    CHECK(probe.oled_at_submit > oled_start && probe.oled_at_done < oled_end,
+          "lecture hors de l'envoi de l'image (%u..%u sur %u..%u)",
+          probe.oled_at_submit, probe.oled_at_done, oled_start, oled_end);
+    CHECK(probe.oled_at_done - probe.oled_at_submit <= I2C_CHUNK_SIZE,
+          "lecture servie après %u octets d'image", probe.oled_at_done - probe.oled_at_submit);
+    CHECK(oled_end - oled_start == GDDRAM_SIZE, "%u octets d'image", oled_end - oled_start);
+    CHECK(memcmp(oled_dev.gddram(), expected, GDDRAM_SIZE) == 0,
+          "GDDRAM différente après reprise des chunks");
+    printf("  lecture capteur servie entre les octets %u et %u de l'image\n",
+           probe.oled_at_submit - oled_start, probe.oled_at_done - oled_start);
+
+    /* Moteur au repos : la soumission doit le réveiller (I2C_QUEUE_EVT_SUBMIT) */
+    char reg = TSL256x_CMD(part_id);
+    uint8_t id = 0;
+    CHECK(queue.write_read(TSL256x_ADDR_LOW, &reg, 1, (char *)&id, 1) == MICROBIT_OK &&
+              id == light0.reg(0x0A),
+          "lecture avec le moteur au repos");
+
+    sim::scheduler_stop();
+}
+
+/* ---------- sensor_registry --------- */
+static sensor_registry *bench_registry()
+{
+    printf("sensor_registry\n");
+
+    static const environment e1 = {18.0, 99000, 60.0};
+    light1.set_channels(300, 150);
+    env1.set_environment(e1.temp_c, e1.press_pa, e1.hum_pct);
+    env0.set_environment(21.5, 101325, 45.0);
+
+    sensor_registry *sensors = new sensor_registry(&uBit, &i2cQueue);
+    int found = sensors->discover(BME280_OS_x16, BME280_SLEEP);
+    printf("  %d capteurs : %u BME280, %u TSL256x\n", found, sensors->nb_env(),
+           sensors->nb_light());
+    CHECK(sensors->nb_env() == 2 && sensors->nb_light() == 2, "découverte incomplète");
+
+    /* Premier échantillon juste après le démarrage : pas de lumière valide */
+    sensor_point points[SENSOR_MAX_POINTS];
+    sensors->sample(points, SENSOR_MAX_POINTS);
+    CHECK(points[0].light == SENSOR_NONE && points[1].light == SENSOR_NONE,
+          "lumière marquée valide avant la fin de l'intégration");
+    uBit.sleep(101);
+
+    bus_span span;
+    int n = sensors->sample(points, SENSOR_MAX_POINTS);
+    printf("  sample : %d points en %llu µs virtuelles (une conversion : %u µs)\n", n,
+           (unsigned long long)span.elapsed_us(), sensors->env(0)->measurement_time_us());
+    CHECK(n == 2, "%d points", n);
+    CHECK(points[0].env == 0 && points[1].env == 1, "valeurs d'environnement invalides");
+    CHECK(points[0].light == 0 && points[1].light == 1, "valeurs de lumière invalides");
+    check_values("point 0", points[0].env_data, {21.5, 101325, 45.0});
+    check_values("point 1", points[1].env_data, e1);
+    CHECK(points[1].comb == 300 && points[1].ir == 150, "point 1 : canaux %u / %u",
+          points[1].comb, points[1].ir);
+    CHECK(span.elapsed_us() < 2 * sensors->env(0)->measurement_time_us(),
+          "les conversions ne sont pas simultanées");
+    return sensors;
+}
+
+int main()
+{
+    sim::bus &bus = sim::i2c_bus();
+    bus.attach(BME280_ADDR, &env0);
+    bus.attach(BME280_ADDR_ALT, &env1);
+    bus.attach(TSL256x_ADDR_LOW, &light0);
+    bus.attach(TSL256x_ADDR_FLOAT, &light1);
+    bus.attach(SSD130x_ADDR, &oled_dev);
+    env0.set_environment(21.5, 101325, 45.0);
+
+    MicroBitPin reset(MICROBIT_ID_IO_P0, MICROBIT_PIN_P0, PIN_CAPABILITY_DIGITAL_OUT);
+    bench_bme280();
+    bench_tsl256x();
+    ssd1306 *oled = bench_ssd1306(&reset);
+    bench_i2c_queue(&reset);
+    sensor_registry *sensors = bench_registry();
+
+    /* Drivers de la boucle capteurs du firmware, profil par défaut */
+    bme280 *env = sensors->env(0);
+    tsl256x *light = sensors->light(0);
+    sensors->set_profile(BME280_PROFILE_WEATHER);
+
+    printf("\nChemins chauds, bus à %d kHz\n", SIM_I2C_DEFAULT_FREQ / 1000);
+    printf("%-26s %10s %10s %10s %12s\n", "opération", "ns hôte", "transferts", "µs bus",
+           "µs virtuelles");
+    measure("bme280 lecture forcée", 20000, [env] {
+        bme280_compensated v;
+        env->sensor_read_compensated(&v);
+    });
+    measure("bme280 read_compensated", 20000, [env] {
+        bme280_compensated v;
+        env->read_compensated(&v);
+    });
+    measure("tsl256x sensor_read", 20000, [light] {
+        uint16_t comb, ir;
+        uint32_t lux;
+        light->sensor_read(&comb, &ir, &lux);
+    });
+    measure("ssd1306 update_screen", 2000, [oled] { oled->update_screen(); });
+    measure("sensor_registry sample", 5000, [sensors] {
+        sensor_point points[SENSOR_MAX_POINTS];
+        sensors->sample(points, SENSOR_MAX_POINTS);
+    });
+
+    if (failures != 0)
+    {
+        printf("\n%d vérification(s) en échec\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("\nToutes les vérifications passent\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*
+ * ============================================================================
+ * Fichier      : gateway_bench.cpp
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Débit de décodage de la passerelle : NB_DEVICES micro:bits à clés
+ *   distinctes, NB_FRAMES trames mélangées, décodées sur 1 thread puis sur
+ *   le pool complet. Affiche frames/s et frames/s par cœur, avec une table
+ *   de clés explicites puis avec des clés dérivées d'une clé maître (cache
+ *   LRU : une seule expansion de clé par device sur toutes les passes).
+ *
+ *   Usage : make gateway-bench
+ * ============================================================================
+ */
+
+#include "cpe_gateway.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define NB_DEVICES 200
+#define NB_FRAMES 2000000
+#define ROUNDS 5
+
+static const uint8_t MASTER_KEY[CPE_KEY_LEN] = {
+    0x00, 0x01, 0x02, 0x03,
+    0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B,
+    0x0C, 0x0D, 0x0E, 0x0F};
+
+static void device_key(uint8_t dev, uint8_t key[CPE_KEY_LEN])
+{
+    for (int i = 0; i < CPE_KEY_LEN; ++i)
+        key[i] = (uint8_t)(dev * 31 + i);
+}
+
+template <typename F>
+static double best_of(F fn)
+{
+    double best = 1e9;
+    for (int r = 0; r < ROUNDS; ++r)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        best = std::min(best, dt.count());
+    }
+    return best;
+}
+
+static int run(bool authenticated, bool derived)
+{
+    /* keys : contextes des émetteurs ; côté passerelle, soit la même
+     * table, soit un cache qui ne connaît que la clé maître           */
+    cpe::key_table keys;
+    cpe::key_cache cache(MASTER_KEY, NB_DEVICES);
+    uint8_t key[CPE_KEY_LEN];
+    for (int d = 0; d < NB_DEVICES; ++d)
+    {
+        if (derived)
+            cpe_derive_device_key(MASTER_KEY, (uint8_t)d, key);
+        else
+            device_key((uint8_t)d, key);
+        keys.add((uint8_t)d, key);
+    }
+
+    /* Trames de référence construites avec la clé de chaque device */
+    size_t stride = CPE_AUTH_PAYLOAD_LEN;
+    std::vector<uint8_t> raw(NB_FRAMES * stride);
+    std::vector<cpe::frame> frames(NB_FRAMES);
+    std::vector<cpe::decoded> out(NB_FRAMES);
+    for (size_t i = 0; i < NB_FRAMES; ++i)
+    {
+        uint8_t dev = (uint8_t)((i * 7919) % NB_DEVICES);
+        cpe_measure_t m = {(int16_t)(2000 + i % 500), 4500, 10130, (int16_t)(i % 1000)};
+        uint8_t *f = &raw[i * stride];
+        size_t len = CPE_PAYLOAD_LEN;
+        cpe_ctx_build_measure_frame(keys.find(dev), &m, dev, (uint8_t)i, f);
+        if (authenticated)
+            len = (size_t)cpe_ctx_auth_seal(keys.find(dev), f, len, stride);
+        frames[i] = {dev, f, len};
+    }
+
+    cpe::gateway gw = derived ? cpe::gateway(cache, authenticated)
+                              : cpe::gateway(keys, authenticated);
+    cpe::thread_pool pool;
+    size_t ok1 = 0, okn = 0;
+
+    double single = best_of([&] { ok1 = gw.decode_batch(frames, out); });
+    double multi = best_of([&] { okn = gw.decode_batch(frames, out, pool); });
+
+    if (ok1 != NB_FRAMES || okn != NB_FRAMES)
+    {
+        fprintf(stderr, "[ERROR] %zu / %zu trames valides\n", ok1 < okn ? ok1 : okn,
+                (size_t)NB_FRAMES);
+        return 1;
+    }
+
+    cpe::key_cache::stats st = cache.counters();
+    if (derived && (st.misses != NB_DEVICES || st.evictions != 0))
+    {
+        fprintf(stderr, "[ERROR] cache : %llu dérivations pour %d devices\n",
+                (unsigned long long)st.misses, NB_DEVICES);
+        return 1;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%s%s", authenticated ? "cmac" : "ctr",
+             derived ? "+kdf" : "");
+    printf("%-10s %u thread(s): %12.0f frames/s | %u thread(s): %12.0f frames/s"
+           " (%.0f frames/s/cœur)\n",
+           name, 1u, NB_FRAMES / single, pool.size(), NB_FRAMES / multi,
+           NB_FRAMES / multi / pool.size());
+    return 0;
+}
+
+/* Cache plus petit que le parc : évictions et re-dérivations pendant le
+ * décodage parallèle, chaque trame doit rester décodable               */
+#define SMALL_CACHE 16
+#define EVICTION_FRAMES 20000
+
+static int check_eviction()
+{
+    cpe::key_table keys;
+    cpe::key_cache cache(MASTER_KEY, SMALL_CACHE);
+    uint8_t key[CPE_KEY_LEN];
+    for (int d = 0; d < NB_DEVICES; ++d)
+    {
+        cpe_derive_device_key(MASTER_KEY, (uint8_t)d, key);
+        keys.add((uint8_t)d, key);
+    }
+
+    std::vector<uint8_t> raw(EVICTION_FRAMES * CPE_PAYLOAD_LEN);
+    std::vector<cpe::frame> frames(EVICTION_FRAMES);
+    std::vector<cpe::decoded> out(EVICTION_FRAMES);
+    for (size_t i = 0; i < EVICTION_FRAMES; ++i)
+    {
+        /* rafales de 8 trames par device */
+        uint8_t dev = (uint8_t)((i / 8 * 7919) % NB_DEVICES);
+        cpe_measure_t m = {(int16_t)i, 4500, 10130, 0};
+        uint8_t *f = &raw[i * CPE_PAYLOAD_LEN];
+        cpe_ctx_build_measure_frame(keys.find(dev), &m, dev, (uint8_t)i, f);
+        frames[i] = {dev, f, CPE_PAYLOAD_LEN};
+    }
+
+    cpe::gateway gw(cache);
+    cpe::thread_pool pool;
+    size_t ok = gw.decode_batch(frames, out, pool);
+    ok += gw.decode_batch(frames, out);
+    cpe::key_cache::stats st = cache.counters();
+    if (ok != 2 * EVICTION_FRAMES || cache.size() != SMALL_CACHE || st.evictions == 0 ||
+        st.hits + st.misses != 2 * EVICTION_FRAMES)
+    {
+        fprintf(stderr, "[ERROR] éviction : %zu trames valides, %zu contextes, %llu évictions\n",
+                ok, cache.size(), (unsigned long long)st.evictions);
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+{
+    printf("CPE gateway : %d devices, %d trames\n", NB_DEVICES, NB_FRAMES);
+    return check_eviction() || run(false, false) || run(true, false) || run(false, true) ||
+           run(true, true);
+}
@@ -0,0 +1,156 @@
+/*
+ * ============================================================================
+ * Fichier      : tc_aes_bench.c
+ * Projet       : Protocole CPE (micro:bit) - outils hôte
+ * Description  :
+ *   Backends AES de tinycrypt (TC_AES_TTABLE = 0, 1, 4) : aes_encrypt.c
+ *   est compilé trois fois avec des symboles renommés (cf. Makefile).
+ *   Vérifie les vecteurs connus (FIPS-197 C.1, SP 800-38A F.1.1) puis
+ *   l'égalité avec le backend octet par octet sur des clés / blocs
+ *   aléatoires, et affiche ns/bloc pour chaque backend.
+ *
+ *   Usage : make tc-aes-bench
+ * ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <tinycrypt/aes.h>
+
+#define ITERATIONS 1000000
+#define RANDOM_KEYS 1000
+#define RANDOM_BLOCKS 100
+
+#define BACKEND_DECL(n)                                                     \
+    int tc_aes128_set_encrypt_key_tt##n(TCAesKeySched_t s, const uint8_t *k); \
+    int tc_aes_encrypt_tt##n(uint8_t *out, const uint8_t *in, const TCAesKeySched_t s);
+BACKEND_DECL(0)
+BACKEND_DECL(1)
+BACKEND_DECL(4)
+
+typedef struct
+{
+    const char *name;
+    int (*set_key)(TCAesKeySched_t, const uint8_t *);
+    int (*encrypt)(uint8_t *, const uint8_t *, const TCAesKeySched_t);
+} backend_t;
+
+static const backend_t backends[] = {
+    {"octets (0)", tc_aes128_set_encrypt_key_tt0, tc_aes_encrypt_tt0},
+    {"T-table 1 Ko (1)", tc_aes128_set_encrypt_key_tt1, tc_aes_encrypt_tt1},
+    {"T-tables 4 Ko (4)", tc_aes128_set_encrypt_key_tt4, tc_aes_encrypt_tt4},
+};
+#define NB_BACKENDS (sizeof(backends) / sizeof(backends[0]))
+
+typedef struct
+{
+    uint8_t key[16], pt[16], ct[16];
+} kat_t;
+
+static const kat_t kats[] = {
+    /* FIPS-197, annexe C.1 */
+    {{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f},
+     {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff},
+     {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a}},
+    /* SP 800-38A, F.1.1 ECB-AES128, blocs 1 et 4 */
+    {{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c},
+     {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a},
+     {0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97}},
+    {{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c},
+     {0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10},
+     {0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4}},
+};
+
+static volatile uint8_t sink;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void random_bytes(uint8_t *p, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        p[i] = (uint8_t)rand();
+}
+
+static int check_kats(const backend_t *b)
+{
+    struct tc_aes_key_sched_struct s;
+    uint8_t out[16];
+
+    for (size_t i = 0; i < sizeof(kats) / sizeof(kats[0]); ++i)
+    {
+        b->set_key(&s, kats[i].key);
+        b->encrypt(out, kats[i].pt, &s);
+        if (memcmp(out, kats[i].ct, 16) != 0)
+        {
+            fprintf(stderr, "[ERROR] %s : vecteur connu %zu faux\n", b->name, i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* même schedule et même chiffré que le backend de référence (0) */
+static int check_reference(const backend_t *b)
+{
+    struct tc_aes_key_sched_struct ref, s;
+    uint8_t key[16], in[16], a[16], c[16];
+
+    srand(1);
+    for (int k = 0; k < RANDOM_KEYS; ++k)
+    {
+        random_bytes(key, sizeof(key));
+        backends[0].set_key(&ref, key);
+        b->set_key(&s, key);
+        if (memcmp(&ref, &s, sizeof(s)) != 0)
+        {
+            fprintf(stderr, "[ERROR] %s : schedule divergent\n", b->name);
+            return -1;
+        }
+        for (int i = 0; i < RANDOM_BLOCKS; ++i)
+        {
+            random_bytes(in, sizeof(in));
+            backends[0].encrypt(a, in, &ref);
+            b->encrypt(c, in, &s);
+            if (memcmp(a, c, 16) != 0)
+            {
+                fprintf(stderr, "[ERROR] %s : bloc divergent\n", b->name);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    struct tc_aes_key_sched_struct s;
+    uint8_t block[16] = {0};
+    double ref_ns = 0;
+
+    printf("tinycrypt AES-128 : %d blocs chaînés par backend\n", ITERATIONS);
+    for (size_t i = 0; i < NB_BACKENDS; ++i)
+    {
+        const backend_t *b = &backends[i];
+        if (check_kats(b) != 0 || check_reference(b) != 0)
+            return 1;
+
+        b->set_key(&s, kats[0].key);
+        double t0 = now_s();
+        for (int n = 0; n < ITERATIONS; ++n)
+            b->encrypt(block, block, &s); /* dépendance : latence réelle */
+        double ns = (now_s() - t0) * 1e9 / ITERATIONS;
+        sink ^= block[0];
+        if (i == 0)
+            ref_ns = ns;
+        printf("%-20s %8.1f ns/bloc  (x%.1f)  vecteurs OK, identique au backend 0\n",
+               b->name, ns, ref_ns / ns);
+    }
+    return 0;
+}
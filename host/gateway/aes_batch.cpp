@@ -0,0 +1,326 @@
+/*
+ * ============================================================================
+ * Fichier      : aes_batch.cpp
+ * Projet       : Protocole CPE (micro:bit) - passerelle hôte
+ * ============================================================================
+ */
+
+#include "aes_batch.h"
+#include "cpe.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPE_HAVE_AESNI 1
+#endif
+
+namespace cpe
+{
+
+/* Clés de tour en octets, dans l'ordre de l'état AES (les mots tinycrypt
+ * sont big-endian : words[4r + c] = rk[r][4c .. 4c + 3]).                */
+static void round_keys(const tc_aes_key_sched_struct &s, uint8_t rk[Nr + 1][16])
+{
+    for (int r = 0; r <= Nr; ++r)
+        for (int c = 0; c < Nb; ++c)
+            for (int j = 0; j < 4; ++j)
+                rk[r][4 * c + j] = (uint8_t)(s.words[Nb * r + c] >> (24 - 8 * j));
+}
+
+/* ---------- Référence --------------- */
+static void tinycrypt_blocks(const tc_aes_key_sched_struct &s, const uint8_t *in,
+                             uint8_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        tc_aes_encrypt(out + 16 * i, in + 16 * i, (TCAesKeySched_t)&s);
+}
+
+/* ---------- Bitslice ---------------- */
+/* q[b][k] : bit k de l'octet b de l'état, pour 64 blocs (un par bit). */
+#define BS_LANES 64
+
+/* S-box AES en circuit booléen (Boyar & Peralta, 113 portes) sur les 8
+ * bits d'un octet ; x[0] est le bit de poids faible.                     */
+static inline void bs_sbox(uint64_t *q)
+{
+    uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11;
+    uint64_t y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+    x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+    /* Transformation linéaire d'entrée */
+    y14 = x3 ^ x5; y13 = x0 ^ x6; y9 = x0 ^ x3; y8 = x0 ^ x5;
+    t0 = x1 ^ x2; y1 = t0 ^ x7; y4 = y1 ^ x3; y12 = y13 ^ y14;
+    y2 = y1 ^ x0; y5 = y1 ^ x6; y3 = y5 ^ y8; t1 = x4 ^ y12;
+    y15 = t1 ^ x5; y20 = t1 ^ x1; y6 = y15 ^ x7; y10 = y15 ^ t0;
+    y11 = y20 ^ y9; y7 = x7 ^ y11; y17 = y10 ^ y11; y19 = y10 ^ y8;
+    y16 = t0 ^ y11; y21 = y13 ^ y16; y18 = x0 ^ y16;
+
+    /* Partie non linéaire (inversion dans GF(2^8)) */
+    t2 = y12 & y15; t3 = y3 & y6; t4 = t3 ^ t2; t5 = y4 & x7;
+    t6 = t5 ^ t2; t7 = y13 & y16; t8 = y5 & y1; t9 = t8 ^ t7;
+    t10 = y2 & y7; t11 = t10 ^ t7; t12 = y9 & y11; t13 = y14 & y17;
+    t14 = t13 ^ t12; t15 = y8 & y10; t16 = t15 ^ t12; t17 = t4 ^ t14;
+    t18 = t6 ^ t16; t19 = t9 ^ t14; t20 = t11 ^ t16; t21 = t17 ^ y20;
+    t22 = t18 ^ y19; t23 = t19 ^ y21; t24 = t20 ^ y18;
+    t25 = t21 ^ t22; t26 = t21 & t23; t27 = t24 ^ t26; t28 = t25 & t27;
+    t29 = t28 ^ t22; t30 = t23 ^ t24; t31 = t22 ^ t26; t32 = t31 & t30;
+    t33 = t32 ^ t24; t34 = t23 ^ t33; t35 = t27 ^ t33; t36 = t24 & t35;
+    t37 = t36 ^ t34; t38 = t27 ^ t36; t39 = t29 & t38; t40 = t25 ^ t39;
+    t41 = t40 ^ t37; t42 = t29 ^ t33; t43 = t29 ^ t40; t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15; z1 = t37 & y6; z2 = t33 & x7; z3 = t43 & y16;
+    z4 = t40 & y1; z5 = t29 & y7; z6 = t42 & y11; z7 = t45 & y17;
+    z8 = t41 & y10; z9 = t44 & y12; z10 = t37 & y3; z11 = t33 & y4;
+    z12 = t43 & y13; z13 = t40 & y5; z14 = t29 & y2; z15 = t42 & y9;
+    z16 = t45 & y14; z17 = t41 & y8;
+
+    /* Transformation linéaire de sortie (affine comprise) */
+    t46 = z15 ^ z16; t47 = z10 ^ z11; t48 = z5 ^ z13; t49 = z9 ^ z10;
+    t50 = z2 ^ z12; t51 = z2 ^ z5; t52 = z7 ^ z8; t53 = z0 ^ z3;
+    t54 = z6 ^ z7; t55 = z16 ^ z17; t56 = z12 ^ t48; t57 = t50 ^ t53;
+    t58 = z4 ^ t46; t59 = z3 ^ t54; t60 = t46 ^ t57; t61 = z14 ^ t57;
+    t62 = t52 ^ t58; t63 = t49 ^ t58; t64 = z4 ^ t59; t65 = t61 ^ t62;
+    t66 = z1 ^ t63; s0 = t59 ^ t63; s6 = t56 ^ ~t62; s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65; s3 = t53 ^ t66; s4 = t51 ^ t66; s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3; s2 = t55 ^ ~t67;
+
+    q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+    q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+/* (r, c) <- (r, c + r) : l'octet b = r + 4c */
+static inline void bs_shift_rows(uint64_t q[16][8])
+{
+    uint64_t t[16][8];
+    memcpy(t, q, sizeof(t));
+    for (int c = 0; c < 4; ++c)
+        for (int r = 1; r < 4; ++r)
+            memcpy(q[r + 4 * c], t[r + 4 * ((c + r) & 3)], sizeof(t[0]));
+}
+
+/* xtime bitslicé : décalage d'un bit et réduction par 0x1b */
+static inline void bs_xtime(const uint64_t a[8], uint64_t o[8])
+{
+    o[0] = a[7];
+    o[1] = a[0] ^ a[7];
+    o[2] = a[1];
+    o[3] = a[2] ^ a[7];
+    o[4] = a[3] ^ a[7];
+    o[5] = a[4];
+    o[6] = a[5];
+    o[7] = a[6];
+}
+
+static inline void bs_mix_columns(uint64_t q[16][8])
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        uint64_t *a[4] = {q[4 * c], q[4 * c + 1], q[4 * c + 2], q[4 * c + 3]};
+        uint64_t all[8], t[8], x[8], o[4][8];
+        for (int k = 0; k < 8; ++k)
+            all[k] = a[0][k] ^ a[1][k] ^ a[2][k] ^ a[3][k];
+        /* o_r = a_r ^ all ^ 2(a_r ^ a_r+1) */
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int k = 0; k < 8; ++k)
+                t[k] = a[r][k] ^ a[(r + 1) & 3][k];
+            bs_xtime(t, x);
+            for (int k = 0; k < 8; ++k)
+                o[r][k] = a[r][k] ^ all[k] ^ x[k];
+        }
+        for (int r = 0; r < 4; ++r)
+            memcpy(a[r], o[r], sizeof(o[r]));
+    }
+}
+
+static inline void bs_add_round_key(uint64_t q[16][8], const uint64_t rk[16][8])
+{
+    for (int b = 0; b < 16; ++b)
+        for (int k = 0; k < 8; ++k)
+            q[b][k] ^= rk[b][k];
+}
+
+static void bs_load(uint64_t q[16][8], const uint8_t *in, size_t lanes)
+{
+    memset(q, 0, sizeof(uint64_t) * 16 * 8);
+    for (size_t j = 0; j < lanes; ++j)
+        for (int b = 0; b < 16; ++b)
+        {
+            uint64_t v = in[16 * j + b];
+            for (int k = 0; k < 8; ++k)
+                q[b][k] |= ((v >> k) & 1) << j;
+        }
+}
+
+static void bs_store(const uint64_t q[16][8], uint8_t *out, size_t lanes)
+{
+    for (size_t j = 0; j < lanes; ++j)
+        for (int b = 0; b < 16; ++b)
+        {
+            uint8_t v = 0;
+            for (int k = 0; k < 8; ++k)
+                v |= (uint8_t)(((q[b][k] >> j) & 1) << k);
+            out[16 * j + b] = v;
+        }
+}
+
+static void bitslice_blocks(const tc_aes_key_sched_struct &s, const uint8_t *in,
+                            uint8_t *out, size_t n)
+{
+    uint8_t rk[Nr + 1][16];
+    uint64_t rkm[Nr + 1][16][8]; /* clé identique sur les 64 voies */
+    uint64_t q[16][8];
+
+    round_keys(s, rk);
+    for (int r = 0; r <= Nr; ++r)
+        for (int b = 0; b < 16; ++b)
+            for (int k = 0; k < 8; ++k)
+                rkm[r][b][k] = 0 - (uint64_t)((rk[r][b] >> k) & 1);
+
+    for (size_t done = 0; done < n; done += BS_LANES)
+    {
+        size_t lanes = std::min<size_t>(BS_LANES, n - done);
+        bs_load(q, in + 16 * done, lanes);
+
+        bs_add_round_key(q, rkm[0]);
+        for (int r = 1; r < Nr; ++r)
+        {
+            for (int b = 0; b < 16; ++b)
+                bs_sbox(q[b]);
+            bs_shift_rows(q);
+            bs_mix_columns(q);
+            bs_add_round_key(q, rkm[r]);
+        }
+        for (int b = 0; b < 16; ++b)
+            bs_sbox(q[b]);
+        bs_shift_rows(q);
+        bs_add_round_key(q, rkm[Nr]);
+
+        bs_store(q, out + 16 * done, lanes);
+    }
+}
+
+/* ---------- AES-NI ------------------ */
+#ifdef CPE_HAVE_AESNI
+#define AESNI_WAYS 8
+
+__attribute__((target("aes,sse2"))) static void aesni_blocks(const tc_aes_key_sched_struct &s,
+                                                             const uint8_t *in, uint8_t *out,
+                                                             size_t n)
+{
+    uint8_t rk[Nr + 1][16];
+    __m128i k[Nr + 1];
+
+    round_keys(s, rk);
+    for (int r = 0; r <= Nr; ++r)
+        k[r] = _mm_loadu_si128((const __m128i *)rk[r]);
+
+    size_t i = 0;
+    for (; i + AESNI_WAYS <= n; i += AESNI_WAYS)
+    {
+        __m128i b[AESNI_WAYS];
+        for (int w = 0; w < AESNI_WAYS; ++w)
+            b[w] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + 16 * (i + w))), k[0]);
+        for (int r = 1; r < Nr; ++r)
+            for (int w = 0; w < AESNI_WAYS; ++w)
+                b[w] = _mm_aesenc_si128(b[w], k[r]);
+        for (int w = 0; w < AESNI_WAYS; ++w)
+            _mm_storeu_si128((__m128i *)(out + 16 * (i + w)), _mm_aesenclast_si128(b[w], k[Nr]));
+    }
+    for (; i < n; ++i)
+    {
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + 16 * i)), k[0]);
+        for (int r = 1; r < Nr; ++r)
+            b = _mm_aesenc_si128(b, k[r]);
+        _mm_storeu_si128((__m128i *)(out + 16 * i), _mm_aesenclast_si128(b, k[Nr]));
+    }
+}
+#endif
+
+/* ---------- API --------------------- */
+aes_backend aes_best_backend()
+{
+#ifdef CPE_HAVE_AESNI
+    static const bool aesni = __builtin_cpu_supports("aes");
+    if (aesni)
+        return aes_backend::aesni;
+#endif
+    return aes_backend::bitslice;
+}
+
+const char *aes_backend_name(aes_backend b)
+{
+    switch (b)
+    {
+    case aes_backend::tinycrypt:
+        return "tinycrypt";
+    case aes_backend::bitslice:
+        return "bitslice";
+    case aes_backend::aesni:
+        return "aesni";
+    }
+    return "?";
+}
+
+void aes_encrypt_blocks(const tc_aes_key_sched_struct &sched, const uint8_t *in,
+                        uint8_t *out, size_t n, aes_backend b)
+{
+    switch (b)
+    {
+    case aes_backend::aesni:
+#ifdef CPE_HAVE_AESNI
+        if (aes_best_backend() == aes_backend::aesni)
+        {
+            aesni_blocks(sched, in, out, n);
+            return;
+        }
+#endif
+        /* pas d'AES-NI : repli portable */
+        [[fallthrough]];
+    case aes_backend::bitslice:
+        bitslice_blocks(sched, in, out, n);
+        return;
+    case aes_backend::tinycrypt:
+        tinycrypt_blocks(sched, in, out, n);
+        return;
+    }
+}
+
+void ctr_crypt_frames(const tc_aes_key_sched_struct &sched, uint8_t *frames, size_t n,
+                      size_t stride, aes_backend b)
+{
+    const size_t chunk = 4 * BS_LANES;
+    uint8_t ks[chunk][16];
+
+    for (size_t done = 0; done < n; done += chunk)
+    {
+        size_t m = std::min(chunk, n - done);
+        memset(ks, 0, m * 16);
+        for (size_t i = 0; i < m; ++i)
+            ks[i][15] = frames[(done + i) * stride]; /* compteur = 0..0|seq */
+        aes_encrypt_blocks(sched, ks[0], ks[0], m, b);
+        for (size_t i = 0; i < m; ++i)
+        {
+            uint8_t *f = frames + (done + i) * stride + 1;
+            for (int j = 0; j < CPE_PLAINTEXT_LEN; ++j)
+                f[j] ^= ks[i][j];
+        }
+    }
+}
+
+} // namespace cpe
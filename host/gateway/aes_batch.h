@@ -0,0 +1,47 @@
+/*
+ * ============================================================================
+ * Fichier      : aes_batch.h
+ * Projet       : Protocole CPE (micro:bit) - passerelle hôte
+ * Description  :
+ *   AES-128 par lots pour la passerelle, à partir d'un schedule tinycrypt :
+ *   - AES-NI (8 blocs entrelacés) quand le CPU le supporte
+ *   - AES bitslicé portable (64 blocs en parallèle, temps constant) sinon
+ *   Les résultats sont identiques bit à bit à tc_aes_encrypt / tc_ctr_mode.
+ * ============================================================================
+ */
+
+#ifndef CPE_AES_BATCH_H
+#define CPE_AES_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tinycrypt/aes.h>
+
+namespace cpe
+{
+
+enum class aes_backend
+{
+    tinycrypt, /* référence, un bloc à la fois */
+    bitslice,
+    aesni,
+};
+
+/* aesni si disponible, bitslice sinon */
+aes_backend aes_best_backend();
+const char *aes_backend_name(aes_backend b);
+
+/* out[i] = AES_K(in[i]) pour n blocs de 16 octets sous le même schedule.
+ * in et out peuvent être confondus.                                      */
+void aes_encrypt_blocks(const tc_aes_key_sched_struct &sched, const uint8_t *in,
+                        uint8_t *out, size_t n, aes_backend b = aes_best_backend());
+
+/* Déchiffre (ou chiffre) en place n trames CPE de CPE_PAYLOAD_LEN octets
+ * (seq | 11 octets), espacées de stride octets, sous la même clé : même
+ * résultat que tc_ctr_mode avec le compteur 0..0|seq.                    */
+void ctr_crypt_frames(const tc_aes_key_sched_struct &sched, uint8_t *frames, size_t n,
+                      size_t stride, aes_backend b = aes_best_backend());
+
+} // namespace cpe
+
+#endif /* CPE_AES_BATCH_H */
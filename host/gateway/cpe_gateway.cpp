@@ -0,0 +1,347 @@
+/*
+ * ============================================================================
+ * Fichier      : cpe_gateway.cpp
+ * Projet       : Protocole CPE (micro:bit) - passerelle hôte
+ * ============================================================================
+ */
+
+#include "cpe_gateway.h"
+#include "aes_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+static_assert(CPE_KS_POOL_LEN == 256,
+              "la passerelle suppose un keystream précalculé pour chaque seq");
+
+namespace cpe
+{
+
+/* ---------- Table de clés ----------- */
+static std::unique_ptr<cpe_ctx_t> make_context(const uint8_t key[CPE_KEY_LEN])
+{
+    auto ctx = std::make_unique<cpe_ctx_t>();
+    cpe_ctx_init(ctx.get(), key);
+
+    /* keystream des 256 séquences en un seul lot (AES-NI / bitslice),
+     * identique à ce que remplirait cpe_ctx_ks_refill                 */
+    uint8_t blocks[CPE_KS_POOL_LEN][16] = {};
+    for (int seq = 0; seq < CPE_KS_POOL_LEN; ++seq)
+        blocks[seq][15] = (uint8_t)seq;
+    aes_encrypt_blocks(ctx->sched, blocks[0], blocks[0], CPE_KS_POOL_LEN);
+    for (int seq = 0; seq < CPE_KS_POOL_LEN; ++seq)
+    {
+        cpe_ks_slot_t &slot = ctx->pool[seq];
+        memcpy(slot.ks, blocks[seq], CPE_PLAINTEXT_LEN);
+        slot.seq = (uint8_t)seq;
+        slot.valid = 1;
+    }
+    return ctx;
+}
+
+void key_table::add(uint8_t device_id, const uint8_t key[CPE_KEY_LEN])
+{
+    contexts[device_id] = make_context(key);
+}
+
+size_t key_table::size() const
+{
+    return std::count_if(contexts.begin(), contexts.end(),
+                         [](const std::unique_ptr<cpe_ctx_t> &c) { return c != nullptr; });
+}
+
+/* ---------- Cache de clés dérivées -- */
+namespace
+{
+
+/* Copie par thread des contextes obtenus du cache owner */
+struct local_slot
+{
+    std::shared_ptr<const cpe_ctx_t> ctx;
+    uint32_t generation = 0;
+};
+
+std::atomic<uint64_t> next_cache_id{1};
+std::atomic<unsigned> next_thread{0};
+
+struct local_contexts
+{
+    uint64_t owner = 0;
+    unsigned shard = next_thread.fetch_add(1, std::memory_order_relaxed);
+    std::array<local_slot, 256> slots;
+};
+
+local_contexts &local()
+{
+    thread_local local_contexts contexts;
+    return contexts;
+}
+
+} // namespace
+
+key_cache::key_cache(const uint8_t master_key[CPE_KEY_LEN], size_t cap)
+    : capacity(std::clamp<size_t>(cap, 1, 256)),
+      id(next_cache_id.fetch_add(1, std::memory_order_relaxed)), used(0), clock(0),
+      misses(0), evictions(0)
+{
+    tc_aes128_set_encrypt_key(&master, master_key);
+}
+
+key_cache::~key_cache()
+{
+    memset(&master, 0, sizeof(master));
+}
+
+const cpe_ctx_t *key_cache::acquire(uint8_t device_id)
+{
+    local_contexts &l = local();
+    if (l.owner == id)
+    {
+        const local_slot &s = l.slots[device_id];
+        entry &e = entries[device_id];
+        if (s.ctx && s.generation == e.generation.load(std::memory_order_acquire))
+        {
+            /* date d'usage écrite au plus une fois par dérivation */
+            uint64_t now = clock.load(std::memory_order_relaxed);
+            if (e.last_use.load(std::memory_order_relaxed) != now)
+                e.last_use.store(now, std::memory_order_relaxed);
+            shards[l.shard % shards.size()].hits.fetch_add(1, std::memory_order_relaxed);
+            return s.ctx.get();
+        }
+    }
+    return acquire_slow(device_id);
+}
+
+const cpe_ctx_t *key_cache::acquire_slow(uint8_t device_id)
+{
+    local_contexts &l = local();
+    if (l.owner != id)
+    {
+        for (local_slot &s : l.slots)
+            s.ctx.reset();
+        l.owner = id;
+    }
+    local_slot &s = l.slots[device_id];
+    entry &e = entries[device_id];
+
+    /* entrée présente (sous lock) : copie locale au thread */
+    auto take = [&]() {
+        shards[l.shard % shards.size()].hits.fetch_add(1, std::memory_order_relaxed);
+        e.last_use.store(clock.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        s.ctx = e.ctx;
+        s.generation = e.generation.load(std::memory_order_relaxed);
+        return s.ctx.get();
+    };
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (e.ctx)
+            return take();
+    }
+
+    /* hors verrou : les autres devices restent décodables pendant ce temps */
+    uint8_t key[CPE_KEY_LEN];
+    cpe_derive_device_key_sched(&master, device_id, key);
+    std::shared_ptr<const cpe_ctx_t> ctx = make_context(key);
+    memset(key, 0, sizeof(key));
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (e.ctx) /* dérivé entre-temps par un autre thread */
+        return take();
+    ++misses;
+    if (used == capacity)
+    {
+        entry *oldest = nullptr;
+        for (entry &v : entries)
+        {
+            if (v.ctx && (!oldest || v.last_use.load(std::memory_order_relaxed) <
+                                         oldest->last_use.load(std::memory_order_relaxed)))
+                oldest = &v;
+        }
+        oldest->ctx.reset();
+        oldest->generation.fetch_add(1, std::memory_order_release);
+        --used;
+        ++evictions;
+    }
+    e.ctx = std::move(ctx);
+    e.generation.fetch_add(1, std::memory_order_release);
+    e.last_use.store(clock.fetch_add(1, std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+    ++used;
+    s.ctx = e.ctx;
+    s.generation = e.generation.load(std::memory_order_relaxed);
+    return s.ctx.get();
+}
+
+size_t key_cache::size() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return used;
+}
+
+key_cache::stats key_cache::counters() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    stats st = {0, misses, evictions};
+    for (const hit_shard &h : shards)
+        st.hits += h.hits.load(std::memory_order_relaxed);
+    return st;
+}
+
+/* ---------- Pool de threads --------- */
+thread_pool::thread_pool(unsigned threads)
+    : job(nullptr), job_len(0), generation(0), pending(0), stopping(false)
+{
+    if (threads == 0)
+        threads = 1;
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back(&thread_pool::run, this, i);
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &w : workers)
+        w.join();
+}
+
+void thread_pool::parallel_for(size_t n, const std::function<void(size_t, size_t)> &fn)
+{
+    std::unique_lock<std::mutex> guard(lock);
+    job = &fn;
+    job_len = n;
+    pending = size();
+    ++generation;
+    wake.notify_all();
+    done.wait(guard, [this] { return pending == 0; });
+    job = nullptr;
+}
+
+void thread_pool::run(unsigned index)
+{
+    unsigned seen = 0;
+    for (;;)
+    {
+        const std::function<void(size_t, size_t)> *fn;
+        size_t n;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            fn = job;
+            n = job_len;
+        }
+
+        size_t chunk = (n + size() - 1) / size();
+        size_t begin = std::min(n, index * chunk);
+        size_t end = std::min(n, begin + chunk);
+        if (begin < end)
+            (*fn)(begin, end);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (--pending == 0)
+            done.notify_one();
+    }
+}
+
+/* ---------- Décodage ---------------- */
+gateway::gateway(const key_table &k, bool auth) : keys(&k), cache(nullptr), authenticated(auth)
+{
+}
+
+gateway::gateway(key_cache &k, bool auth) : keys(nullptr), cache(&k), authenticated(auth)
+{
+}
+
+/* Sélectionne la clé et vérifie le tag éventuel ; retourne la longueur de
+ * la trame interne ou -1, sans rien déchiffrer en cas d'échec. Un contexte
+ * du cache reste valide jusqu'au prochain open du même thread.          */
+int gateway::open(const frame &in, const cpe_ctx_t *&ctx) const
+{
+    if (cache)
+        ctx = cache->acquire(in.device_id);
+    else
+        ctx = keys->find(in.device_id);
+    if (!ctx || !in.bytes)
+        return -1;
+    if (!authenticated)
+        return (int)in.len;
+    return cpe_ctx_auth_check(ctx, in.bytes, in.len);
+}
+
+int gateway::decode(const frame &in, decoded &out) const
+{
+    const cpe_ctx_t *ctx;
+
+    out.status = -1;
+    if (open(in, ctx) != CPE_PAYLOAD_LEN)
+        return -1;
+    out.seq = in.bytes[0];
+    if (cpe_ctx_parse_frame(ctx, in.bytes, &out.type, &out.device_id,
+                            &out.measure, &out.ctrl) != 0)
+        return -1;
+    if (out.device_id != in.device_id) /* mauvaise clé ou usurpation */
+        return -1;
+    out.status = 0;
+    return 0;
+}
+
+size_t gateway::decode_batch(std::span<const frame> frames, std::span<decoded> out) const
+{
+    size_t ok = 0;
+    size_t n = std::min(frames.size(), out.size());
+    for (size_t i = 0; i < n; ++i)
+        ok += decode(frames[i], out[i]) == 0;
+    return ok;
+}
+
+size_t gateway::decode_batch(std::span<const frame> frames, std::span<decoded> out,
+                             thread_pool &pool) const
+{
+    std::atomic<size_t> ok(0);
+    size_t n = std::min(frames.size(), out.size());
+    pool.parallel_for(n, [&](size_t begin, size_t end) {
+        ok += decode_batch(frames.subspan(begin, end - begin),
+                           out.subspan(begin, end - begin));
+    });
+    return ok;
+}
+
+int gateway::decode_samples(const frame &in, std::span<cpe_sample_t> out) const
+{
+    const cpe_ctx_t *ctx;
+    uint8_t dev;
+
+    int len = open(in, ctx);
+    if (len <= CPE_PAYLOAD_LEN)
+        return -1;
+    int n = cpe_ctx_parse_measure_batch(ctx, in.bytes, (size_t)len, &dev, out.data(),
+                                        (uint8_t)std::min<size_t>(out.size(), 255));
+    if (n < 0 || dev != in.device_id)
+        return -1;
+    return n;
+}
+
+int gateway::decode_points(const frame &in, std::span<cpe_point_t> out) const
+{
+    const cpe_ctx_t *ctx;
+    uint8_t dev;
+
+    int len = open(in, ctx);
+    if (len <= CPE_PAYLOAD_LEN)
+        return -1;
+    int n = cpe_ctx_parse_multi_frame(ctx, in.bytes, (size_t)len, &dev, out.data(),
+                                      (uint8_t)std::min<size_t>(out.size(), 255));
+    if (n < 0 || dev != in.device_id)
+        return -1;
+    return n;
+}
+
+} // namespace cpe
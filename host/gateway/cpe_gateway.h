@@ -0,0 +1,249 @@
+/*
+ * ============================================================================
+ * Fichier      : cpe_gateway.h
+ * Projet       : Protocole CPE (micro:bit) - passerelle hôte
+ * Description  :
+ *   Décodage CPE côté passerelle, pour des centaines de micro:bits :
+ *   - une table de clés par device (un cpe_ctx_t chacun, pas d'état global)
+ *   - ou des clés dérivées d'une clé maître, gardées dans un cache LRU
+ *   - decode_batch() réentrant, exécutable sur un pool de threads
+ *
+ *   Les contextes sont compilés avec un pool de keystream couvrant les 256
+ *   numéros de séquence : une fois la clé ajoutée, décoder une trame ne
+ *   coûte plus aucun bloc AES.
+ * ============================================================================
+ */
+
+#ifndef CPE_GATEWAY_H
+#define CPE_GATEWAY_H
+
+#ifndef CPE_KS_POOL_LEN
+#define CPE_KS_POOL_LEN 256 /* un bloc par seq possible (cf. Makefile) */
+#endif
+
+#include "cpe.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace cpe
+{
+
+/* Trame reçue (vue, sans copie). device_id est fourni par le transport
+ * (récepteur dédié, pont série...) et sélectionne la clé ; il doit être
+ * confirmé par l'identifiant chiffré dans la trame.                     */
+struct frame
+{
+    uint8_t device_id;
+    const uint8_t *bytes;
+    size_t len;
+};
+
+struct decoded
+{
+    int status; /* 0 si la trame est valide, -1 sinon */
+    cpe_frame_type_t type;
+    uint8_t device_id;
+    uint8_t seq;
+    cpe_measure_t measure; /* CPE_FT_MEASURE */
+    uint8_t ctrl;          /* CPE_FT_CONTROL (ordre) / CPE_FT_PROFILE */
+};
+
+/* Schéma de la mesure vu de la passerelle, généré depuis
+ * CPE_MEASURE_FIELDS (cpe.h) comme le pack / unpack du firmware.        */
+struct field
+{
+    const char *name;
+    unsigned offset; /* dans les CPE_MEASURE_LEN octets de la mesure */
+    unsigned width;
+    bool is_signed;
+    int scale; /* valeur physique = brute / scale */
+};
+
+#define CPE_GW_FIELD(name, width, type, scale) \
+    field{#name, CPE_MOFF_##name, width, std::is_signed_v<type>, scale},
+inline constexpr field measure_schema[] = {CPE_MEASURE_FIELDS(CPE_GW_FIELD)};
+#undef CPE_GW_FIELD
+
+static_assert(std::size(measure_schema) == CPE_MEASURE_NFIELDS);
+static_assert(measure_schema[CPE_MEASURE_NFIELDS - 1].offset +
+                  measure_schema[CPE_MEASURE_NFIELDS - 1].width ==
+              CPE_MEASURE_LEN);
+
+/* Valeurs physiques de m, dans l'ordre du schéma */
+inline std::array<double, CPE_MEASURE_NFIELDS> measure_values(const cpe_measure_t &m)
+{
+#define CPE_GW_VALUE(name, width, type, scale) (double)m.name / (scale),
+    return {CPE_MEASURE_FIELDS(CPE_GW_VALUE)};
+#undef CPE_GW_VALUE
+}
+
+/* fn(const field &, double) pour chaque champ de m */
+template <typename F>
+void for_each_field(const cpe_measure_t &m, F &&fn)
+{
+    auto values = measure_values(m);
+    for (size_t i = 0; i < values.size(); ++i)
+        fn(measure_schema[i], values[i]);
+}
+
+/* Table des clés par device : expansion de clé et keystream calculés une
+ * fois à l'ajout, lecture seule ensuite (partageable entre threads).     */
+class key_table
+{
+    public:
+        /* Ajoute ou remplace la clé d'un device. Non réentrant. */
+        void add(uint8_t device_id, const uint8_t key[CPE_KEY_LEN]);
+
+        /* Contexte du device, ou nullptr si inconnu */
+        const cpe_ctx_t *find(uint8_t device_id) const
+        {
+            return contexts[device_id].get();
+        }
+
+        size_t size() const;
+
+    private:
+        std::array<std::unique_ptr<cpe_ctx_t>, 256> contexts;
+};
+
+/* Clés dérivées d'une clé maître (cpe_derive_device_key) : les contextes
+ * étendus des capacity devices les plus récents sont gardés dans le
+ * cache ; une trame d'un device présent ne relance ni dérivation ni
+ * expansion de clé. Réentrant.
+ * Chaque thread garde devant la table partagée une copie des contextes
+ * qu'il a déjà obtenus, validée par le numéro de génération de l'entrée :
+ * un accès présent ne prend aucun verrou et ne touche à aucun compteur de
+ * références. Le verrou n'est pris qu'au premier accès d'un thread à un
+ * device, après une éviction ou sur une dérivation. L'éviction choisit
+ * l'entrée la moins récemment utilisée, la date d'usage avançant à chaque
+ * dérivation (LRU approché).                                              */
+class key_cache
+{
+    public:
+        struct stats
+        {
+            uint64_t hits;
+            uint64_t misses; /* dérivation + expansion + keystream */
+            uint64_t evictions;
+        };
+
+        explicit key_cache(const uint8_t master_key[CPE_KEY_LEN], size_t capacity = 256);
+        ~key_cache();
+
+        key_cache(const key_cache &) = delete;
+        key_cache &operator=(const key_cache &) = delete;
+
+        /* Contexte du device, dérivé au premier accès ou après éviction ;
+         * valide pour le thread appelant jusqu'à son prochain acquire (un
+         * contexte évincé entre-temps reste utilisable).                  */
+        const cpe_ctx_t *acquire(uint8_t device_id);
+
+        size_t size() const;
+        stats counters() const;
+
+    private:
+        const cpe_ctx_t *acquire_slow(uint8_t device_id);
+
+        /* Une ligne de cache par entrée : les lectures des autres threads
+         * ne partagent pas la ligne d'une entrée modifiée                  */
+        struct alignas(64) entry
+        {
+            std::shared_ptr<const cpe_ctx_t> ctx; /* sous lock */
+            std::atomic<uint32_t> generation{0};  /* change à chaque pose / éviction */
+            std::atomic<uint64_t> last_use{0};    /* date de la dernière dérivation vue */
+        };
+
+        /* Compteur de hits réparti par thread, sommé par counters() */
+        struct alignas(64) hit_shard
+        {
+            std::atomic<uint64_t> hits{0};
+        };
+
+        tc_aes_key_sched_struct master;
+        size_t capacity;
+        uint64_t id; /* distingue les caches dans les copies par thread */
+        mutable std::mutex lock;
+        size_t used;
+        std::atomic<uint64_t> clock; /* avance à chaque dérivation */
+        std::array<entry, 256> entries;
+        std::array<hit_shard, 16> shards;
+        uint64_t misses;
+        uint64_t evictions;
+};
+
+/* Pool de threads minimal : découpe [0, n) en tranches contiguës. */
+class thread_pool
+{
+    public:
+        explicit thread_pool(unsigned threads = std::thread::hardware_concurrency());
+        ~thread_pool();
+
+        thread_pool(const thread_pool &) = delete;
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        unsigned size() const { return (unsigned)workers.size(); }
+
+        /* Appelle fn(begin, end) sur chaque tranche et attend la fin */
+        void parallel_for(size_t n, const std::function<void(size_t, size_t)> &fn);
+
+    private:
+        void run(unsigned index);
+
+        std::vector<std::thread> workers;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::condition_variable done;
+        const std::function<void(size_t, size_t)> *job;
+        size_t job_len;
+        unsigned generation;
+        unsigned pending;
+        bool stopping;
+};
+
+class gateway
+{
+    public:
+        /* authenticated : trames suivies d'un tag CMAC (cpe_auth_seal) */
+        explicit gateway(const key_table &keys, bool authenticated = false);
+        /* clés dérivées par device : contextes pris dans le cache */
+        explicit gateway(key_cache &keys, bool authenticated = false);
+
+        /* Décode une trame MEASURE / CONTROL / PROFILE. Réentrant. */
+        int decode(const frame &in, decoded &out) const;
+
+        /* Décode frames[i] dans out[i] (out.size() >= frames.size()) ;
+         * retourne le nombre de trames valides.                          */
+        size_t decode_batch(std::span<const frame> frames, std::span<decoded> out) const;
+        size_t decode_batch(std::span<const frame> frames, std::span<decoded> out,
+                            thread_pool &pool) const;
+
+        /* Trames longues (MEASURE_BATCH / MEASURE_SERIES) ; retourne le
+         * nombre d'échantillons décodés ou -1.                           */
+        int decode_samples(const frame &in, std::span<cpe_sample_t> out) const;
+
+        /* Trames MEASURE_MULTI (un nœud, plusieurs points de mesure) ;
+         * retourne le nombre de points décodés ou -1.                    */
+        int decode_points(const frame &in, std::span<cpe_point_t> out) const;
+
+    private:
+        int open(const frame &in, const cpe_ctx_t *&ctx) const;
+
+        const key_table *keys;
+        key_cache *cache;
+        bool authenticated;
+};
+
+} // namespace cpe
+
+#endif /* CPE_GATEWAY_H */
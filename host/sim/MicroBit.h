@@ -0,0 +1,142 @@
+/*
+ * ============================================================================
+ * Fichier      : MicroBit.h
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * Description  :
+ *   Sous-ensemble du DAL micro:bit utilisé par les drivers (I2C, sleep,
+ *   storage, fibres, événements), pour compiler les drivers de
+ *   source/drivers sans modification sur l'hôte. L'I2C est routé vers les
+ *   périphériques simulés de sim_bus.h ; le temps est virtuel : sleep() et
+ *   chaque octet transféré font avancer sim::clock.
+ *   Le planificateur de fibres est arrêté par défaut :
+ *   fiber_scheduler_running() vaut 0 et la file I2C exécute les
+ *   transactions dans l'appelant. sim::scheduler_start() (sim_bus.h) le
+ *   démarre pour faire tourner le moteur de la file dans sa fibre.
+ * ============================================================================
+ */
+
+#ifndef CPE_SIM_MICROBIT_H
+#define CPE_SIM_MICROBIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#define MICROBIT_OK 0
+#define MICROBIT_INVALID_PARAMETER -1001
+#define MICROBIT_NOT_SUPPORTED -1002
+#define MICROBIT_CALIBRATION_IN_PROGRESS -1003
+#define MICROBIT_CALIBRATION_REQUIRED -1004
+#define MICROBIT_NO_RESOURCES -1005
+#define MICROBIT_BUSY -1006
+#define MICROBIT_CANCELLED -1007
+#define MICROBIT_I2C_ERROR -1010
+#define MICROBIT_NO_DATA -1012
+
+#define MICROBIT_STORAGE_KEY_SIZE 16
+#define MICROBIT_STORAGE_VALUE_SIZE 32
+
+#define MICROBIT_ID_IO_P0 7
+#define MICROBIT_PIN_P0 0
+#define PIN_CAPABILITY_DIGITAL_OUT 1
+#define I2C_SDA0 0
+#define I2C_SCL0 1
+
+typedef int PinName;
+
+/* ---------- Événements / fibres ----- */
+/* Période du tick du planificateur : une fibre endormie se réveille au
+ * premier tick après son échéance                                      */
+#define SYSTEM_TICK_PERIOD_MS 6
+
+enum MicroBitEventLaunchMode
+{
+    CREATE_ONLY,
+    CREATE_AND_FIRE
+};
+
+class MicroBitEvent
+{
+  public:
+    uint16_t source;
+    uint16_t value;
+    uint64_t timestamp;
+
+    MicroBitEvent(uint16_t source, uint16_t value, MicroBitEventLaunchMode mode = CREATE_AND_FIRE);
+    MicroBitEvent();
+    void fire();
+};
+
+struct Fiber;
+Fiber *create_fiber(void (*entry_fn)(void), void (*completion_fn)(void) = NULL);
+Fiber *create_fiber(void (*entry_fn)(void *), void *param, void (*completion_fn)(void *) = NULL);
+int fiber_scheduler_running();
+void schedule();
+void fiber_sleep(unsigned long t);
+int fiber_wait_for_event(uint16_t id, uint16_t value);
+void release_fiber();
+unsigned long system_timer_current_time();
+uint64_t system_timer_current_time_us();
+
+/* ---------- Périphériques ----------- */
+class MicroBitI2C
+{
+  public:
+    MicroBitI2C(PinName sda, PinName scl);
+    /* address sur 8 bits (adresse 7 bits << 1), comme le DAL */
+    int write(int address, const char *data, int length, bool repeated = false);
+    int read(int address, char *data, int length, bool repeated = false);
+};
+
+class MicroBitPin
+{
+  public:
+    MicroBitPin(int id, PinName name, int capability);
+    int setDigitalValue(int value);
+    int getDigitalValue();
+
+  private:
+    int level;
+};
+
+class MicroBitDisplay
+{
+  public:
+    int scroll(const char *s, int delay = 0);
+    unsigned scrolled = 0; /* messages d'erreur des drivers */
+};
+
+struct KeyValuePair
+{
+    uint8_t key[MICROBIT_STORAGE_KEY_SIZE];
+    uint8_t value[MICROBIT_STORAGE_VALUE_SIZE];
+};
+
+/* Flash simulée : table en mémoire, même contrat que le DAL (get()
+ * retourne une copie à libérer par delete, NULL si absente)          */
+#define SIM_STORAGE_SLOTS 21
+class MicroBitStorage
+{
+  public:
+    int put(const char *key, uint8_t *data, int size);
+    KeyValuePair *get(const char *key);
+    int remove(const char *key);
+    int size();
+
+  private:
+    KeyValuePair slots[SIM_STORAGE_SLOTS];
+    bool used[SIM_STORAGE_SLOTS] = {};
+};
+
+class MicroBit
+{
+  public:
+    MicroBitDisplay display;
+    MicroBitStorage storage;
+
+    void init() {}
+    void sleep(uint32_t milliseconds);
+};
+
+#endif /* CPE_SIM_MICROBIT_H */
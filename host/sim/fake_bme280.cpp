@@ -0,0 +1,287 @@
+/*
+ * ============================================================================
+ * Fichier      : fake_bme280.cpp
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * ============================================================================
+ */
+
+#include "fake_bme280.h"
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+namespace sim
+{
+
+/* Adresses des registres (datasheet BME280, section 5.3) */
+#define REG_CAL_TP 0x88
+#define REG_CHIP_ID 0xD0
+#define REG_RESET 0xE0
+#define REG_CAL_H 0xE1
+#define REG_CTRL_HUM 0xF2
+#define REG_STATUS 0xF3
+#define REG_CTRL_MEAS 0xF4
+#define REG_CONFIG 0xF5
+#define REG_DATA 0xF7
+
+#define CHIP_ID 0x60
+#define RESET_MAGIC 0xB6
+#define STATUS_MEASURING 0x08
+#define MODE_SLEEP 0x00
+#define MODE_NORMAL 0x03
+
+/* T1 27504, T2 26435, T3 -1000, P1 36477, P2 -10685, P3 3024, P4 2855,
+ * P5 140, P6 -7, P7 15500, P8 -14600, P9 6000 ; H1 75, H2 362, H3 0,
+ * H4 313, H5 50, H6 30                                                */
+const bme280_cal_blob bme280_datasheet_blob = {
+    {0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, 0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B, 0x27,
+     0x0B, 0x8C, 0x00, 0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17, 0x00, 0x4B},
+    {0x6A, 0x01, 0x00, 0x13, 0x29, 0x03, 0x1E},
+};
+
+/* Facteur d'oversampling : 0 (canal désactivé), 1, 2, 4, 8, 16 */
+static uint32_t os_factor(uint8_t os)
+{
+    if (os == 0)
+        return 0;
+    return 1u << ((os > 5 ? 5 : os) - 1);
+}
+
+/* Standby du mode normal (config[7:5]), en µs */
+static const uint32_t standby_us[8] = {500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000};
+
+fake_bme280::fake_bme280(const bme280_cal_blob &blob)
+{
+    memset(regs, 0, sizeof(regs));
+    memcpy(&regs[REG_CAL_TP], blob.tp, FAKE_BME280_CAL_TP_LEN);
+    memcpy(&regs[REG_CAL_H], blob.h, FAKE_BME280_CAL_H_LEN);
+    regs[REG_CHIP_ID] = CHIP_ID;
+
+    /* Lecture de la calibration indépendante de celle du driver */
+    const uint8_t *tp = blob.tp;
+    const uint8_t *h = blob.h;
+    auto u16 = [tp](int i) { return (uint16_t)(tp[i] | (tp[i + 1] << 8)); };
+    cal.T1 = u16(0);
+    cal.T2 = (int16_t)u16(2);
+    cal.T3 = (int16_t)u16(4);
+    cal.P1 = u16(6);
+    cal.P2 = (int16_t)u16(8);
+    cal.P3 = (int16_t)u16(10);
+    cal.P4 = (int16_t)u16(12);
+    cal.P5 = (int16_t)u16(14);
+    cal.P6 = (int16_t)u16(16);
+    cal.P7 = (int16_t)u16(18);
+    cal.P8 = (int16_t)u16(20);
+    cal.P9 = (int16_t)u16(22);
+    cal.H1 = tp[25];
+    cal.H2 = (int16_t)(h[0] | (h[1] << 8));
+    cal.H3 = h[2];
+    cal.H4 = (int16_t)(((int8_t)h[3] * 16) | (h[4] & 0x0F));
+    cal.H5 = (int16_t)(((int8_t)h[5] * 16) | (h[4] >> 4));
+    cal.H6 = (int8_t)h[6];
+
+    reset();
+}
+
+/* Valeurs de reset : sommeil, tout à 0, registres de données invalides */
+void fake_bme280::reset()
+{
+    regs[REG_CTRL_HUM] = 0;
+    regs[REG_STATUS] = 0;
+    regs[REG_CTRL_MEAS] = 0;
+    regs[REG_CONFIG] = 0;
+    static const uint8_t invalid[8] = {0x80, 0x00, 0x00, 0x80, 0x00, 0x00, 0x80, 0x00};
+    memcpy(&regs[REG_DATA], invalid, sizeof(invalid));
+    hum_os = 0;
+    converting = false;
+}
+
+/* Temps de mesure typique (datasheet, annexe B) :
+ *   1 + 2 * T_os + (2 * P_os + 0.5) + (2 * H_os + 0.5) ms              */
+uint32_t fake_bme280::conversion_time_us() const
+{
+    uint32_t t_os = os_factor((regs[REG_CTRL_MEAS] >> 5) & 0x07);
+    uint32_t p_os = os_factor((regs[REG_CTRL_MEAS] >> 2) & 0x07);
+    uint32_t h_os = os_factor(hum_os);
+    uint32_t us = 1000 + 2000 * t_os;
+
+    if (p_os != 0)
+        us += 2000 * p_os + 500;
+    if (h_os != 0)
+        us += 2000 * h_os + 500;
+    return (uint32_t)lround(us * timing_scale);
+}
+
+/* Fin de conversion : registres de données, canaux désactivés à 0x80000 / 0x8000 */
+void fake_bme280::publish()
+{
+    uint32_t p = ((regs[REG_CTRL_MEAS] >> 2) & 0x07) ? raw_p : 0x80000;
+    uint32_t t = ((regs[REG_CTRL_MEAS] >> 5) & 0x07) ? (uint32_t)raw_t : 0x80000;
+    uint32_t h = hum_os ? raw_h : 0x8000;
+    uint8_t *d = &regs[REG_DATA];
+
+    d[0] = (uint8_t)(p >> 12);
+    d[1] = (uint8_t)(p >> 4);
+    d[2] = (uint8_t)(p << 4);
+    d[3] = (uint8_t)(t >> 12);
+    d[4] = (uint8_t)(t >> 4);
+    d[5] = (uint8_t)(t << 4);
+    d[6] = (uint8_t)(h >> 8);
+    d[7] = (uint8_t)h;
+    nb_conversions++;
+}
+
+/* Avance l'état du composant jusqu'à l'instant courant */
+void fake_bme280::update()
+{
+    uint64_t now = now_us();
+    uint8_t mode = regs[REG_CTRL_MEAS] & 0x03;
+
+    regs[REG_STATUS] &= ~STATUS_MEASURING;
+    if (mode == MODE_NORMAL)
+    {
+        /* Cycles mesure + standby ; les données suivent la dernière mesure finie */
+        uint64_t t_meas = conversion_time_us();
+        uint64_t period = t_meas + standby_us[regs[REG_CONFIG] >> 5];
+        uint64_t elapsed = now - normal_start;
+        uint64_t done = (elapsed >= t_meas) ? (elapsed - t_meas) / period + 1 : 0;
+
+        if (done > normal_cycles)
+        {
+            publish();
+            normal_cycles = done;
+        }
+        if ((elapsed % period) < t_meas)
+            regs[REG_STATUS] |= STATUS_MEASURING;
+        return;
+    }
+    if (!converting)
+        return;
+    if (now < conv_end)
+    {
+        regs[REG_STATUS] |= STATUS_MEASURING;
+        return;
+    }
+    converting = false;
+    publish();
+    regs[REG_CTRL_MEAS] &= ~0x03; /* retour en sommeil */
+}
+
+void fake_bme280::write_reg(uint8_t address, uint8_t value)
+{
+    switch (address)
+    {
+    case REG_RESET:
+        if (value == RESET_MAGIC)
+            reset();
+        break;
+    case REG_CTRL_HUM:
+        regs[REG_CTRL_HUM] = value & 0x07;
+        break;
+    case REG_CONFIG:
+        if ((regs[REG_CTRL_MEAS] & 0x03) == MODE_NORMAL)
+        {
+            nb_config_ignored++;
+            break;
+        }
+        regs[REG_CONFIG] = value & 0xFD;
+        break;
+    case REG_CTRL_MEAS:
+        regs[REG_CTRL_MEAS] = value;
+        hum_os = regs[REG_CTRL_HUM];
+        switch (value & 0x03)
+        {
+        case MODE_SLEEP:
+            converting = false;
+            break;
+        case MODE_NORMAL:
+            converting = false;
+            normal_start = now_us();
+            normal_cycles = 0;
+            break;
+        default: /* forcé */
+            converting = true;
+            conv_end = now_us() + conversion_time_us();
+            break;
+        }
+        break;
+    default:
+        /* Registres en lecture seule : écriture ignorée */
+        break;
+    }
+}
+
+bool fake_bme280::write(const uint8_t *data, size_t len)
+{
+    update();
+    if (len == 0)
+        return true;
+    /* Un octet seul : sélection du registre avant une lecture */
+    if (len == 1)
+    {
+        pointer = data[0];
+        return true;
+    }
+    for (size_t i = 0; i + 1 < len; i += 2)
+    {
+        write_reg(data[i], data[i + 1]);
+        update();
+    }
+    return true;
+}
+
+bool fake_bme280::read(uint8_t *data, size_t len)
+{
+    update();
+    for (size_t i = 0; i < len; i++)
+        data[i] = regs[pointer++];
+    return true;
+}
+
+void fake_bme280::set_raw(uint32_t adc_p, int32_t adc_t, uint16_t adc_h)
+{
+    raw_p = adc_p & 0xFFFFF;
+    raw_t = adc_t & 0xFFFFF;
+    raw_h = adc_h;
+}
+
+/* Valeur brute dans [lo, hi] dont l'image par f (monotone) est la plus
+ * proche de target                                                     */
+static uint32_t invert(uint32_t lo, uint32_t hi, double target,
+                       const std::function<double(uint32_t)> &f)
+{
+    bool rising = f(hi) > f(lo);
+    uint32_t a = lo, b = hi;
+
+    while (b - a > 1)
+    {
+        uint32_t mid = a + (b - a) / 2;
+        if ((f(mid) < target) == rising)
+            a = mid;
+        else
+            b = mid;
+    }
+    return (fabs(f(a) - target) <= fabs(f(b) - target)) ? a : b;
+}
+
+void fake_bme280::set_environment(double temp_c, double press_pa, double hum_pct)
+{
+    const bme280_calibration_data *c = &cal;
+
+    uint32_t adc_t = invert(0, 0xFFFFF, temp_c * 100, [c](uint32_t x) {
+        return (double)bme280_compensate_temperature(bme280_compensate_t_fine(c, (int32_t)x));
+    });
+    int32_t t_fine = bme280_compensate_t_fine(c, (int32_t)adc_t);
+    /* La compensation 32 bits retourne 0 sur 0 et déborde au-delà de 0xF0000
+     * (moins de 50 hPa, hors de la plage du capteur)                     */
+    uint32_t adc_p = invert(1, 0xF0000, press_pa, [c, t_fine](uint32_t x) {
+        return (double)bme280_compensate_pressure(c, t_fine, (int32_t)x);
+    });
+    uint32_t adc_h = invert(0, 0xFFFF, hum_pct * 100, [c, t_fine](uint32_t x) {
+        return (double)bme280_compensate_humidity(c, t_fine, (int32_t)x);
+    });
+    set_raw(adc_p, (int32_t)adc_t, (uint16_t)adc_h);
+}
+
+} // namespace sim
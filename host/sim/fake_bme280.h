@@ -0,0 +1,92 @@
+/*
+ * ============================================================================
+ * Fichier      : fake_bme280.h
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * Description  :
+ *   BME280 simulé au niveau registre (carte de bme280_internal_regs et des
+ *   plages de calibration 0x88 .. 0xA1 / 0xE1 .. 0xE7) :
+ *   - pointeur de registre auto-incrémenté, écritures par paires
+ *     (registre, valeur) comme sur le composant ;
+ *   - ctrl_hum pris en compte à l'écriture suivante de ctrl_meas, config
+ *     ignoré en mode normal, reset 0xB6 ;
+ *   - conversion forcée : bit measuring de status levé pendant le temps
+ *     typique de la datasheet (annexe B) multiplié par timing_scale, puis
+ *     retour en sommeil et mise à jour des registres de données ;
+ *   - canal désactivé (oversampling skip) : 0x80000 / 0x8000.
+ *
+ *   set_environment() inverse la compensation (bme280_compensate.h) pour
+ *   produire les valeurs brutes d'une température / pression / humidité.
+ * ============================================================================
+ */
+
+#ifndef CPE_SIM_FAKE_BME280_H
+#define CPE_SIM_FAKE_BME280_H
+
+#include "sim_bus.h"
+#include "bme280_compensate.h"
+
+namespace sim
+{
+
+/* Image de calibration, dans l'ordre des registres */
+#define FAKE_BME280_CAL_TP_LEN 26 /* 0x88 .. 0xA1 */
+#define FAKE_BME280_CAL_H_LEN 7   /* 0xE1 .. 0xE7 */
+struct bme280_cal_blob
+{
+    uint8_t tp[FAKE_BME280_CAL_TP_LEN];
+    uint8_t h[FAKE_BME280_CAL_H_LEN];
+};
+
+/* Jeu de calibration de l'exemple de compensation des datasheets Bosch
+ * (T1..P9), humidité H1..H6 relevée sur un capteur : le même que celui
+ * des benchs de compensation.                                           */
+extern const bme280_cal_blob bme280_datasheet_blob;
+
+class fake_bme280 : public device
+{
+  public:
+    explicit fake_bme280(const bme280_cal_blob &blob = bme280_datasheet_blob);
+
+    bool write(const uint8_t *data, size_t len) override;
+    bool read(uint8_t *data, size_t len) override;
+
+    /* Valeurs brutes des ADC publiées à la fin de la prochaine conversion */
+    void set_raw(uint32_t adc_p, int32_t adc_t, uint16_t adc_h);
+    /* °C, Pa, %rH : valeurs brutes dont la compensation 32 bits donne le
+     * plus proche de ces valeurs                                        */
+    void set_environment(double temp_c, double press_pa, double hum_pct);
+
+    /* Facteur appliqué au temps de conversion typique (1.0 par défaut,
+     * 0 : conversion instantanée)                                       */
+    void set_timing_scale(double scale) { timing_scale = scale; }
+    uint32_t conversion_time_us() const;
+
+    const bme280_calibration_data &calibration() const { return cal; }
+    uint8_t reg(uint8_t address) const { return regs[address]; }
+    unsigned conversions() const { return nb_conversions; }
+    unsigned config_ignored() const { return nb_config_ignored; }
+
+  private:
+    void reset();
+    void write_reg(uint8_t address, uint8_t value);
+    void update();
+    void publish();
+
+    uint8_t regs[256];
+    uint8_t pointer = 0;
+    uint8_t hum_os = 0; /* ctrl_hum effectif (verrouillé par ctrl_meas) */
+    bool converting = false;
+    uint64_t conv_end = 0;
+    uint64_t normal_start = 0;
+    uint64_t normal_cycles = 0; /* cycles du mode normal déjà publiés */
+    double timing_scale = 1.0;
+    uint32_t raw_p = 0, raw_h = 0;
+    int32_t raw_t = 0;
+    unsigned nb_conversions = 0;
+    unsigned nb_config_ignored = 0;
+    bme280_calibration_data cal;
+};
+
+} // namespace sim
+
+#endif /* CPE_SIM_FAKE_BME280_H */
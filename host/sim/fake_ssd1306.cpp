@@ -0,0 +1,158 @@
+/*
+ * ============================================================================
+ * Fichier      : fake_ssd1306.cpp
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * ============================================================================
+ */
+
+#include "fake_ssd1306.h"
+
+namespace sim
+{
+
+#define CTRL_CO 0x80
+#define CTRL_DC 0x40
+
+#define MODE_HORIZONTAL 0x00
+#define MODE_VERTICAL 0x01
+#define MODE_PAGE 0x02
+
+/* Nombre d'arguments de chaque commande (datasheet SSD1306, section 9) */
+static uint8_t nb_args(uint8_t cmd)
+{
+    switch (cmd)
+    {
+    case 0x20: /* mode d'adressage */
+    case 0x81: /* contraste */
+    case 0x8D: /* pompe de charge */
+    case 0xA8: /* mux */
+    case 0xD3: /* décalage */
+    case 0xD5: /* horloge */
+    case 0xD9: /* précharge */
+    case 0xDA: /* broches COM */
+    case 0xDB: /* VCOMH */
+        return 1;
+    case 0x21: /* fenêtre de colonnes */
+    case 0x22: /* fenêtre de pages */
+    case 0xA3: /* zone de défilement vertical */
+        return 2;
+    case 0x29: /* défilement vertical et horizontal */
+    case 0x2A:
+        return 5;
+    case 0x26: /* défilement horizontal */
+    case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+void fake_ssd1306::execute()
+{
+    uint8_t c = cmd[0];
+
+    nb_commands++;
+    if (c <= 0x0F)
+        col = (col & 0xF0) | c;
+    else if (c <= 0x1F)
+        col = ((c & 0x07) << 4) | (col & 0x0F);
+    else if (c >= 0xB0 && c <= 0xB7)
+        page = c & 0x07;
+    else if (c == 0xAE || c == 0xAF)
+        on = (c == 0xAF);
+    else if (c == 0x20)
+        mode = cmd[1] & 0x03;
+    else if (c == 0x21)
+    {
+        col_start = cmd[1] & 0x7F;
+        col_end = cmd[2] & 0x7F;
+        col = col_start;
+    }
+    else if (c == 0x22)
+    {
+        page_start = cmd[1] & 0x07;
+        page_end = cmd[2] & 0x07;
+        page = page_start;
+    }
+    else if (c == 0x81)
+        contrast_level = cmd[1];
+    else if (c == 0xA8)
+        mux = cmd[1] & 0x3F;
+    else if (c == 0xD3)
+        offset = cmd[1] & 0x3F;
+    /* Les autres commandes ne changent rien au contenu de la GDDRAM */
+}
+
+void fake_ssd1306::command(uint8_t byte)
+{
+    if (cmd_len == 0)
+        cmd_expected = nb_args(byte);
+    cmd[cmd_len++] = byte;
+    if (cmd_len > cmd_expected)
+    {
+        execute();
+        cmd_len = 0;
+    }
+}
+
+/* Écriture GDDRAM et avance du pointeur selon le mode d'adressage */
+void fake_ssd1306::data(uint8_t byte)
+{
+    ram[page][col] = byte;
+    nb_data++;
+    switch (mode)
+    {
+    case MODE_HORIZONTAL:
+        if (col++ >= col_end)
+        {
+            col = col_start;
+            page = (page >= page_end) ? page_start : page + 1;
+        }
+        break;
+    case MODE_VERTICAL:
+        if (page++ >= page_end)
+        {
+            page = page_start;
+            col = (col >= col_end) ? col_start : col + 1;
+        }
+        break;
+    default:
+        /* Adressage par page : la colonne reboucle sans changer de page */
+        col = (col + 1) % FAKE_SSD1306_COLS;
+        break;
+    }
+}
+
+bool fake_ssd1306::write(const uint8_t *bytes, size_t len)
+{
+    size_t i = 0;
+
+    while (i < len)
+    {
+        uint8_t control = bytes[i++];
+        bool is_data = (control & CTRL_DC) != 0;
+
+        /* Co à 1 : un seul octet suit, puis un nouvel octet de contrôle */
+        size_t end = (control & CTRL_CO) ? i + 1 : len;
+        if (end > len)
+            end = len;
+        for (; i < end; i++)
+        {
+            if (is_data)
+                data(bytes[i]);
+            else
+                command(bytes[i]);
+        }
+    }
+    return true;
+}
+
+/* Octet d'état : D6 à 1 quand l'affichage est éteint */
+bool fake_ssd1306::read(uint8_t *bytes, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+        bytes[i] = on ? 0x00 : 0x40;
+    return true;
+}
+
+} // namespace sim
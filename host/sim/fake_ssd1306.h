@@ -0,0 +1,70 @@
+/*
+ * ============================================================================
+ * Fichier      : fake_ssd1306.h
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * Description  :
+ *   Contrôleur OLED SSD1306 simulé : GDDRAM de 8 pages x 128 colonnes et
+ *   interpréteur de commandes.
+ *   - octets de contrôle Co / D/C : 0x80 (un octet de commande), 0xC0 (un
+ *     octet de données), 0x00 / 0x40 (commandes / données jusqu'au stop) ;
+ *   - commandes à arguments (0x20, 0x21, 0x22, 0x81, 0xA8, 0xD3...) : les
+ *     arguments attendus sont pris dans les octets de commande suivants,
+ *     y compris ceux d'un transfert ultérieur ;
+ *   - adressage horizontal, vertical et par page, avec les fenêtres de
+ *     colonnes / pages de 0x21 / 0x22.
+ * ============================================================================
+ */
+
+#ifndef CPE_SIM_FAKE_SSD1306_H
+#define CPE_SIM_FAKE_SSD1306_H
+
+#include "sim_bus.h"
+
+namespace sim
+{
+
+#define FAKE_SSD1306_PAGES 8
+#define FAKE_SSD1306_COLS 128
+
+class fake_ssd1306 : public device
+{
+  public:
+    bool write(const uint8_t *data, size_t len) override;
+    bool read(uint8_t *data, size_t len) override;
+
+    /* GDDRAM dans l'ordre d'un balayage horizontal complet */
+    const uint8_t *gddram() const { return ram[0]; }
+    bool display_on() const { return on; }
+    uint8_t contrast() const { return contrast_level; }
+    uint8_t mux_ratio() const { return mux; }
+    uint8_t display_offset() const { return offset; }
+    uint8_t addressing_mode() const { return mode; }
+
+    unsigned commands() const { return nb_commands; }
+    unsigned data_bytes() const { return nb_data; }
+
+  private:
+    void command(uint8_t byte);
+    void execute();
+    void data(uint8_t byte);
+
+    uint8_t ram[FAKE_SSD1306_PAGES][FAKE_SSD1306_COLS] = {};
+    uint8_t mode = 0x02; /* reset : adressage par page */
+    uint8_t col_start = 0, col_end = FAKE_SSD1306_COLS - 1;
+    uint8_t page_start = 0, page_end = FAKE_SSD1306_PAGES - 1;
+    uint8_t col = 0, page = 0;
+    bool on = false;
+    uint8_t contrast_level = 0x7F;
+    uint8_t mux = 63;
+    uint8_t offset = 0;
+    /* Commande en cours et ses arguments */
+    uint8_t cmd[8] = {};
+    uint8_t cmd_len = 0;
+    uint8_t cmd_expected = 0;
+    unsigned nb_commands = 0;
+    unsigned nb_data = 0;
+};
+
+} // namespace sim
+
+#endif /* CPE_SIM_FAKE_SSD1306_H */
@@ -0,0 +1,135 @@
+/*
+ * ============================================================================
+ * Fichier      : fake_tsl256x.cpp
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * ============================================================================
+ */
+
+#include "fake_tsl256x.h"
+
+#include <cmath>
+
+namespace sim
+{
+
+/* Registres (datasheet TSL2560/TSL2561, Register Set) */
+#define REG_CONTROL 0x0
+#define REG_TIMING 0x1
+#define REG_ID 0xA
+#define REG_DATA0 0xC
+
+#define CMD_BIT 0x80
+#define POWER_ON 0x03
+
+fake_tsl256x::fake_tsl256x(uint8_t part_id)
+{
+    regs[REG_TIMING] = 0x02; /* reset : gain x1, 402 ms */
+    regs[REG_ID] = part_id;
+}
+
+void fake_tsl256x::set_channels(uint16_t ch0, uint16_t ch1)
+{
+    channel[0] = ch0;
+    channel[1] = ch1;
+}
+
+bool fake_tsl256x::powered() const
+{
+    return power && now_us() >= power_on_at + power_up_us;
+}
+
+/* 13.7, 101 et 402 ms ; intégration manuelle : jamais terminée */
+uint32_t fake_tsl256x::integration_us() const
+{
+    static const uint32_t times_us[3] = {13700, 101000, 402000};
+    uint8_t integ = regs[REG_TIMING] & 0x03;
+
+    if (integ > 2)
+        return UINT32_MAX;
+    return (uint32_t)lround(times_us[integ] * timing_scale);
+}
+
+void fake_tsl256x::write_reg(uint8_t address, uint8_t value)
+{
+    switch (address)
+    {
+    case REG_CONTROL:
+        value &= POWER_ON;
+        if (value == POWER_ON && !power)
+        {
+            power = true;
+            power_on_at = now_us();
+            integration_start = power_on_at + power_up_us;
+        }
+        else if (value == 0)
+        {
+            power = false;
+        }
+        regs[REG_CONTROL] = value;
+        break;
+    case REG_TIMING:
+        /* Changer la durée relance l'intégration */
+        regs[REG_TIMING] = value & 0x1B;
+        integration_start = now_us();
+        break;
+    case REG_ID:
+    case 0xB:
+    case 0xC:
+    case 0xD:
+    case 0xE:
+    case 0xF:
+        /* Lecture seule */
+        break;
+    default:
+        regs[address] = value;
+        break;
+    }
+}
+
+uint8_t fake_tsl256x::read_reg(uint8_t address)
+{
+    if (address == REG_CONTROL)
+    {
+        nb_control_reads++;
+        return powered() ? regs[REG_CONTROL] : 0x00;
+    }
+    if (address >= REG_DATA0)
+    {
+        bool valid = powered() && now_us() >= integration_start + integration_us();
+        uint16_t value = valid ? channel[(address - REG_DATA0) >> 1] : 0;
+        return (address & 1) ? (uint8_t)(value >> 8) : (uint8_t)value;
+    }
+    return regs[address];
+}
+
+/* Le premier octet d'une écriture est toujours une commande */
+bool fake_tsl256x::write(const uint8_t *data, size_t len)
+{
+    if (len == 0)
+        return true;
+    if (!(data[0] & CMD_BIT))
+    {
+        nb_bad_commands++;
+        return true;
+    }
+    /* Le bit CLEAR acquitte l'interruption, sans effet sur les registres */
+    pointer = data[0] & 0x0F;
+    for (size_t i = 1; i < len; i++)
+    {
+        write_reg(pointer, data[i]);
+        pointer = (pointer + 1) & 0x0F;
+    }
+    return true;
+}
+
+bool fake_tsl256x::read(uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        data[i] = read_reg(pointer);
+        pointer = (pointer + 1) & 0x0F;
+    }
+    return true;
+}
+
+} // namespace sim
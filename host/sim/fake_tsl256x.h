@@ -0,0 +1,66 @@
+/*
+ * ============================================================================
+ * Fichier      : fake_tsl256x.h
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * Description  :
+ *   TSL256x simulé au niveau registre (carte de tsl256x_internal_regs) :
+ *   - octet de commande (bit CMD, adresse sur 4 bits) puis données, le
+ *     pointeur de registre s'incrémente à chaque octet ;
+ *   - control : mise sous tension (0x03), relu à 0x03 seulement après un
+ *     délai de mise sous tension configurable (0 par défaut, la datasheet
+ *     ne donne pas de valeur) ;
+ *   - ID : numéro de pièce et révision, 0x50 par défaut (TSL2561T rev 0) ;
+ *   - data0 / data1 : à 0 jusqu'à la fin de la première intégration
+ *     (13.7, 101 ou 402 ms selon timing, multiplié par timing_scale),
+ *     puis les valeurs données par set_channels().
+ * ============================================================================
+ */
+
+#ifndef CPE_SIM_FAKE_TSL256X_H
+#define CPE_SIM_FAKE_TSL256X_H
+
+#include "sim_bus.h"
+
+namespace sim
+{
+
+#define FAKE_TSL256x_PART_ID 0x50
+
+class fake_tsl256x : public device
+{
+  public:
+    explicit fake_tsl256x(uint8_t part_id = FAKE_TSL256x_PART_ID);
+
+    bool write(const uint8_t *data, size_t len) override;
+    bool read(uint8_t *data, size_t len) override;
+
+    /* Comptes ADC du canal 0 (visible + IR) et du canal 1 (IR) */
+    void set_channels(uint16_t ch0, uint16_t ch1);
+    void set_power_up_us(uint32_t us) { power_up_us = us; }
+    void set_timing_scale(double scale) { timing_scale = scale; }
+
+    bool powered() const;
+    uint8_t reg(uint8_t address) const { return regs[address & 0x0F]; }
+    unsigned control_reads() const { return nb_control_reads; }
+    unsigned bad_commands() const { return nb_bad_commands; }
+
+  private:
+    uint32_t integration_us() const;
+    void write_reg(uint8_t address, uint8_t value);
+    uint8_t read_reg(uint8_t address);
+
+    uint8_t regs[16] = {};
+    uint8_t pointer = 0;
+    bool power = false;
+    uint64_t power_on_at = 0;
+    uint64_t integration_start = 0;
+    uint32_t power_up_us = 0;
+    double timing_scale = 1.0;
+    uint16_t channel[2] = {};
+    unsigned nb_control_reads = 0;
+    unsigned nb_bad_commands = 0;
+};
+
+} // namespace sim
+
+#endif /* CPE_SIM_FAKE_TSL256X_H */
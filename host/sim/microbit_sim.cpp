@@ -0,0 +1,344 @@
+/*
+ * ============================================================================
+ * Fichier      : microbit_sim.cpp
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * Description  :
+ *   Implémentation du sous-ensemble du DAL déclaré dans MicroBit.h :
+ *   temps virtuel (sim::now_us), I2C vers sim::i2c_bus(), flash en mémoire,
+ *   fibres coopératives une fois sim::scheduler_start() appelé.
+ * ============================================================================
+ */
+
+#include "MicroBit.h"
+#include "sim_bus.h"
+
+#include <cstdlib>
+#include <memory>
+#include <ucontext.h>
+#include <vector>
+
+/* ---------- Fibres ----------------- */
+/* Planificateur coopératif minimal (ucontext) : tourniquet entre les
+ * fibres prêtes ; quand toutes attendent, l'horloge virtuelle saute au
+ * prochain réveil d'une fibre endormie.                               */
+#define SIM_FIBER_STACK_SIZE (64 * 1024)
+
+struct Fiber
+{
+    ucontext_t ctx;
+    std::vector<char> stack; /* vide pour la fibre principale */
+    void (*entry)(void *) = NULL;
+    void (*entry_noarg)(void) = NULL;
+    void *param = NULL;
+    bool waiting = false;
+    uint16_t wait_source = 0;
+    uint16_t wait_value = 0;
+    bool sleeping = false;
+    uint64_t wake_us = 0;
+    bool finished = false;
+};
+
+static bool scheduler_on = false;
+static std::vector<std::unique_ptr<Fiber>> fibers; /* [0] : fibre principale */
+static size_t current = 0;
+
+static bool runnable(Fiber *f)
+{
+    if (f->finished || f->waiting)
+        return false;
+    if (f->sleeping && sim::now_us() < f->wake_us)
+        return false;
+    f->sleeping = false;
+    return true;
+}
+
+static void fiber_trampoline()
+{
+    Fiber *f = fibers[current].get();
+    if (f->entry != NULL)
+        f->entry(f->param);
+    else
+        f->entry_noarg();
+    release_fiber();
+}
+
+static Fiber *spawn(void (*entry)(void *), void (*entry_noarg)(void), void *param)
+{
+    if (!scheduler_on)
+        return NULL;
+
+    std::unique_ptr<Fiber> f(new Fiber);
+    f->entry = entry;
+    f->entry_noarg = entry_noarg;
+    f->param = param;
+    f->stack.resize(SIM_FIBER_STACK_SIZE);
+    getcontext(&f->ctx);
+    f->ctx.uc_stack.ss_sp = f->stack.data();
+    f->ctx.uc_stack.ss_size = f->stack.size();
+    f->ctx.uc_link = NULL;
+    makecontext(&f->ctx, fiber_trampoline, 0);
+    fibers.push_back(std::move(f));
+    return fibers.back().get();
+}
+
+namespace sim
+{
+
+void scheduler_start()
+{
+    if (scheduler_on)
+        return;
+    fibers.clear();
+    fibers.emplace_back(new Fiber);
+    current = 0;
+    scheduler_on = true;
+}
+
+void scheduler_stop()
+{
+    if (!scheduler_on)
+        return;
+    if (current != 0)
+    {
+        fprintf(stderr, "[sim] scheduler_stop() hors de la fibre principale\n");
+        abort();
+    }
+    scheduler_on = false;
+    fibers.clear();
+}
+
+} // namespace sim
+
+MicroBitEvent::MicroBitEvent(uint16_t src, uint16_t val, MicroBitEventLaunchMode mode)
+    : source(src), value(val), timestamp(sim::now_us())
+{
+    if (mode == CREATE_AND_FIRE)
+        fire();
+}
+
+MicroBitEvent::MicroBitEvent() : source(0), value(0), timestamp(sim::now_us())
+{
+}
+
+/* Réveille les fibres qui attendent l'événement ; elles tournent au
+ * prochain schedule(), comme avec le DAL                             */
+void MicroBitEvent::fire()
+{
+    if (!scheduler_on)
+        return;
+    for (auto &f : fibers)
+    {
+        if (f->waiting && f->wait_source == source && f->wait_value == value)
+            f->waiting = false;
+    }
+}
+
+Fiber *create_fiber(void (*entry_fn)(void), void (*)(void))
+{
+    return spawn(NULL, entry_fn, NULL);
+}
+
+Fiber *create_fiber(void (*entry_fn)(void *), void *param, void (*)(void *))
+{
+    return spawn(entry_fn, NULL, param);
+}
+
+int fiber_scheduler_running()
+{
+    return scheduler_on ? 1 : 0;
+}
+
+void schedule()
+{
+    if (!scheduler_on)
+        return;
+    for (;;)
+    {
+        size_t n = fibers.size();
+        for (size_t k = 1; k <= n; k++)
+        {
+            size_t next = (current + k) % n;
+            if (!runnable(fibers[next].get()))
+                continue;
+            if (next != current)
+            {
+                size_t prev = current;
+                current = next;
+                swapcontext(&fibers[prev]->ctx, &fibers[next]->ctx);
+            }
+            return;
+        }
+
+        /* Aucune fibre prête : prochain réveil */
+        uint64_t wake = UINT64_MAX;
+        for (auto &f : fibers)
+        {
+            if (f->sleeping && !f->finished && f->wake_us < wake)
+                wake = f->wake_us;
+        }
+        if (wake == UINT64_MAX)
+        {
+            fprintf(stderr, "[sim] interblocage : toutes les fibres attendent un événement\n");
+            abort();
+        }
+        sim::advance_us(wake - sim::now_us());
+    }
+}
+
+void fiber_sleep(unsigned long t)
+{
+    if (!scheduler_on)
+    {
+        sim::advance_us((uint64_t)t * 1000);
+        return;
+    }
+    /* Réveil au premier tick du planificateur après l'échéance */
+    const uint64_t tick_us = SYSTEM_TICK_PERIOD_MS * 1000;
+    uint64_t wake = sim::now_us() + (uint64_t)t * 1000;
+    Fiber *f = fibers[current].get();
+    f->sleeping = true;
+    f->wake_us = (wake + tick_us - 1) / tick_us * tick_us;
+    schedule();
+}
+
+int fiber_wait_for_event(uint16_t id, uint16_t value)
+{
+    if (!scheduler_on)
+        return MICROBIT_NOT_SUPPORTED;
+    Fiber *f = fibers[current].get();
+    f->waiting = true;
+    f->wait_source = id;
+    f->wait_value = value;
+    schedule();
+    return MICROBIT_OK;
+}
+
+void release_fiber()
+{
+    if (!scheduler_on)
+        return;
+    fibers[current]->finished = true;
+    schedule();
+}
+
+unsigned long system_timer_current_time()
+{
+    return (unsigned long)(sim::now_us() / 1000);
+}
+
+uint64_t system_timer_current_time_us()
+{
+    return sim::now_us();
+}
+
+void MicroBit::sleep(uint32_t milliseconds)
+{
+    fiber_sleep(milliseconds);
+}
+
+/* ---------- I2C ---------------------- */
+MicroBitI2C::MicroBitI2C(PinName, PinName)
+{
+}
+
+/* 'repeated' (pas de stop) ne change rien pour les périphériques simulés :
+ * le pointeur de registre est gardé d'un transfert à l'autre.          */
+int MicroBitI2C::write(int address, const char *data, int length, bool)
+{
+    return sim::i2c_bus().write((uint8_t)address, (const uint8_t *)data, (size_t)length);
+}
+
+int MicroBitI2C::read(int address, char *data, int length, bool)
+{
+    return sim::i2c_bus().read((uint8_t)address, (uint8_t *)data, (size_t)length);
+}
+
+/* ---------- Broches / écran --------- */
+MicroBitPin::MicroBitPin(int, PinName, int) : level(0)
+{
+}
+
+int MicroBitPin::setDigitalValue(int value)
+{
+    level = value ? 1 : 0;
+    return MICROBIT_OK;
+}
+
+int MicroBitPin::getDigitalValue()
+{
+    return level;
+}
+
+int MicroBitDisplay::scroll(const char *s, int)
+{
+    scrolled++;
+    fprintf(stderr, "[display] %s\n", s);
+    return MICROBIT_OK;
+}
+
+/* ---------- Flash ------------------- */
+static bool same_key(const uint8_t *stored, const char *key)
+{
+    return strncmp((const char *)stored, key, MICROBIT_STORAGE_KEY_SIZE) == 0;
+}
+
+int MicroBitStorage::put(const char *key, uint8_t *data, int size)
+{
+    if (size > MICROBIT_STORAGE_VALUE_SIZE || strlen(key) >= MICROBIT_STORAGE_KEY_SIZE)
+        return MICROBIT_INVALID_PARAMETER;
+
+    int slot = -1;
+    for (int i = 0; i < SIM_STORAGE_SLOTS; i++)
+    {
+        if (used[i] && same_key(slots[i].key, key))
+        {
+            slot = i;
+            break;
+        }
+        if (!used[i] && slot < 0)
+            slot = i;
+    }
+    if (slot < 0)
+        return MICROBIT_NO_RESOURCES;
+
+    memset(&slots[slot], 0, sizeof(KeyValuePair));
+    memcpy(slots[slot].key, key, strlen(key));
+    memcpy(slots[slot].value, data, size);
+    used[slot] = true;
+    return MICROBIT_OK;
+}
+
+KeyValuePair *MicroBitStorage::get(const char *key)
+{
+    for (int i = 0; i < SIM_STORAGE_SLOTS; i++)
+    {
+        if (used[i] && same_key(slots[i].key, key))
+        {
+            KeyValuePair *kv = new KeyValuePair;
+            memcpy(kv, &slots[i], sizeof(KeyValuePair));
+            return kv;
+        }
+    }
+    return NULL;
+}
+
+int MicroBitStorage::remove(const char *key)
+{
+    for (int i = 0; i < SIM_STORAGE_SLOTS; i++)
+    {
+        if (used[i] && same_key(slots[i].key, key))
+        {
+            used[i] = false;
+            return MICROBIT_OK;
+        }
+    }
+    return MICROBIT_NO_DATA;
+}
+
+int MicroBitStorage::size()
+{
+    int n = 0;
+    for (int i = 0; i < SIM_STORAGE_SLOTS; i++)
+        n += used[i] ? 1 : 0;
+    return n;
+}
@@ -0,0 +1,77 @@
+/*
+ * ============================================================================
+ * Fichier      : sim_bus.cpp
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * ============================================================================
+ */
+
+#include "sim_bus.h"
+#include "MicroBit.h"
+
+namespace sim
+{
+
+/* ---------- Horloge virtuelle ------- */
+static uint64_t clock_us = 0;
+
+uint64_t now_us()
+{
+    return clock_us;
+}
+
+void advance_us(uint64_t us)
+{
+    clock_us += us;
+}
+
+/* ---------- Bus ---------------------- */
+void bus::attach(uint8_t address, device *dev)
+{
+    devices[address >> 1] = dev;
+}
+
+void bus::detach(uint8_t address)
+{
+    devices[address >> 1] = nullptr;
+}
+
+/* start + adresse, puis les données si l'adresse est acquittée, + stop */
+void bus::account(size_t len, bool acked)
+{
+    uint64_t bits = 1 + 9 + (acked ? 9 * len : 0) + 1;
+    uint64_t us = (bits * 1000000 + frequency - 1) / frequency;
+
+    counters.transfers++;
+    counters.busy_us += us;
+    if (acked)
+        counters.bytes += len;
+    else
+        counters.nacks++;
+    advance_us(us);
+}
+
+int bus::write(uint8_t address, const uint8_t *data, size_t len)
+{
+    device *dev = devices[address >> 1];
+    bool acked = (dev != nullptr) && dev->write(data, len);
+
+    account(len, acked);
+    return acked ? MICROBIT_OK : MICROBIT_I2C_ERROR;
+}
+
+int bus::read(uint8_t address, uint8_t *data, size_t len)
+{
+    device *dev = devices[address >> 1];
+    bool acked = (dev != nullptr) && dev->read(data, len);
+
+    account(len, acked);
+    return acked ? MICROBIT_OK : MICROBIT_I2C_ERROR;
+}
+
+bus &i2c_bus()
+{
+    static bus instance;
+    return instance;
+}
+
+} // namespace sim
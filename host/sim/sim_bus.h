@@ -0,0 +1,87 @@
+/*
+ * ============================================================================
+ * Fichier      : sim_bus.h
+ * Projet       : Protocole CPE (micro:bit) - simulateur hôte
+ * Description  :
+ *   Bus I2C simulé et horloge virtuelle. Les périphériques simulés
+ *   (fake_bme280, fake_tsl256x, fake_ssd1306) s'attachent à une adresse
+ *   8 bits, comme celles des drivers (BME280_ADDR, SSD130x_ADDR...).
+ *
+ *   Chaque transfert fait avancer l'horloge du temps qu'il prendrait sur
+ *   le bus (9 bits par octet, adresse comprise, plus start / stop) : les
+ *   benchs mesurent ainsi le temps bus d'une opération des drivers, en
+ *   plus de leur coût CPU sur l'hôte.
+ * ============================================================================
+ */
+
+#ifndef CPE_SIM_BUS_H
+#define CPE_SIM_BUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sim
+{
+
+/* ---------- Horloge virtuelle ------- */
+uint64_t now_us();
+void advance_us(uint64_t us);
+
+/* ---------- Périphérique ------------ */
+/* Un transfert (écriture ou lecture) entre start et stop ; retourner
+ * false fait un NACK de l'adresse.                                    */
+class device
+{
+  public:
+    virtual ~device() = default;
+    virtual bool write(const uint8_t *data, size_t len) = 0;
+    virtual bool read(uint8_t *data, size_t len) = 0;
+};
+
+struct bus_stats
+{
+    uint64_t transfers;
+    uint64_t bytes; /* octets de données, hors adresse */
+    uint64_t nacks;
+    uint64_t busy_us; /* temps bus cumulé */
+};
+
+/* ---------- Bus ---------------------- */
+#define SIM_I2C_DEFAULT_FREQ 100000 /* fréquence du DAL micro:bit */
+
+class bus
+{
+  public:
+    void attach(uint8_t address, device *dev);
+    void detach(uint8_t address);
+    void set_frequency(uint32_t hz) { frequency = hz; }
+
+    /* Transferts du DAL : MICROBIT_OK ou MICROBIT_I2C_ERROR */
+    int write(uint8_t address, const uint8_t *data, size_t len);
+    int read(uint8_t address, uint8_t *data, size_t len);
+
+    const bus_stats &stats() const { return counters; }
+    void reset_stats() { counters = {}; }
+
+  private:
+    void account(size_t len, bool acked);
+
+    device *devices[128] = {};
+    uint32_t frequency = SIM_I2C_DEFAULT_FREQ;
+    bus_stats counters = {};
+};
+
+/* Bus unique, celui de MicroBitI2C */
+bus &i2c_bus();
+
+/* ---------- Fibres ----------------- */
+/* Démarre le planificateur coopératif du DAL simulé : l'appelant devient
+ * la fibre principale, create_fiber() crée de vraies fibres et
+ * fiber_scheduler_running() vaut 1. scheduler_stop(), depuis la fibre
+ * principale, abandonne les autres fibres sans dérouler leur pile.     */
+void scheduler_start();
+void scheduler_stop();
+
+} // namespace sim
+
+#endif /* CPE_SIM_BUS_H */
@@ -0,0 +1,48 @@
+/*
+ * ============================================================================
+ * Fichier      : crypto_bench.h
+ * Projet       : Protocole CPE (micro:bit)
+ * Description  :
+ *   Micro-benchmarks des primitives tinycrypt aux tailles utilisées par CPE
+ *   (11, 16 et 240 octets). Le même code tourne sur la cible (horloge
+ *   system_timer_current_time_us) et sur l'hôte (make crypto-bench) : seule
+ *   l'horloge et l'affichage sont fournis par l'appelant.
+ * ============================================================================
+ */
+
+#ifndef CRYPTO_BENCH_H
+#define CRYPTO_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    const char *name;     /* primitive, ex. "tc_ctr_mode" */
+    size_t bytes;         /* taille traitée par appel (0 : sans objet) */
+    uint32_t iterations;
+    uint64_t elapsed_us;  /* durée totale des iterations appels */
+} crypto_bench_result_t;
+
+/* horloge monotone en microsecondes */
+typedef uint64_t (*crypto_bench_clock_t)(void);
+typedef void (*crypto_bench_report_t)(const crypto_bench_result_t *r, void *user);
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /* Mesure chaque primitive sur iterations appels et appelle report
+     * après chacune (l'appelant peut y céder la main / imprimer).
+     * Retourne le nombre de mesures effectuées.                        */
+    int crypto_bench_run(crypto_bench_clock_t clock_us,
+                         crypto_bench_report_t report,
+                         void *user,
+                         uint32_t iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRYPTO_BENCH_H */
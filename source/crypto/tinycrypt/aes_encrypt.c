@@ -34,30 +34,78 @@
  #include <tinycrypt/utils.h>
  #include <tinycrypt/constants.h>
  
- static const uint8_t sbox[256] = {
-     0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b,
-     0xfe, 0xd7, 0xab, 0x76, 0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
-     0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0, 0xb7, 0xfd, 0x93, 0x26,
-     0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
-     0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2,
-     0xeb, 0x27, 0xb2, 0x75, 0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
-     0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84, 0x53, 0xd1, 0x00, 0xed,
-     0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
-     0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f,
-     0x50, 0x3c, 0x9f, 0xa8, 0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
-     0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2, 0xcd, 0x0c, 0x13, 0xec,
-     0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
-     0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14,
-     0xde, 0x5e, 0x0b, 0xdb, 0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
-     0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79, 0xe7, 0xc8, 0x37, 0x6d,
-     0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
-     0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f,
-     0x4b, 0xbd, 0x8b, 0x8a, 0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
-     0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e, 0xe1, 0xf8, 0x98, 0x11,
-     0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
-     0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f,
-     0xb0, 0x54, 0xbb, 0x16
- };
+ /*
+  * S-box values, listed once and expanded both into the byte table and,
+  * when TC_AES_TTABLE is set, into the 32-bit round tables.
+  */
+ #define SBOX_VALUES(X) \
+     X(0x63) X(0x7c) X(0x77) X(0x7b) X(0xf2) X(0x6b) X(0x6f) X(0xc5) \
+     X(0x30) X(0x01) X(0x67) X(0x2b) X(0xfe) X(0xd7) X(0xab) X(0x76) \
+     X(0xca) X(0x82) X(0xc9) X(0x7d) X(0xfa) X(0x59) X(0x47) X(0xf0) \
+     X(0xad) X(0xd4) X(0xa2) X(0xaf) X(0x9c) X(0xa4) X(0x72) X(0xc0) \
+     X(0xb7) X(0xfd) X(0x93) X(0x26) X(0x36) X(0x3f) X(0xf7) X(0xcc) \
+     X(0x34) X(0xa5) X(0xe5) X(0xf1) X(0x71) X(0xd8) X(0x31) X(0x15) \
+     X(0x04) X(0xc7) X(0x23) X(0xc3) X(0x18) X(0x96) X(0x05) X(0x9a) \
+     X(0x07) X(0x12) X(0x80) X(0xe2) X(0xeb) X(0x27) X(0xb2) X(0x75) \
+     X(0x09) X(0x83) X(0x2c) X(0x1a) X(0x1b) X(0x6e) X(0x5a) X(0xa0) \
+     X(0x52) X(0x3b) X(0xd6) X(0xb3) X(0x29) X(0xe3) X(0x2f) X(0x84) \
+     X(0x53) X(0xd1) X(0x00) X(0xed) X(0x20) X(0xfc) X(0xb1) X(0x5b) \
+     X(0x6a) X(0xcb) X(0xbe) X(0x39) X(0x4a) X(0x4c) X(0x58) X(0xcf) \
+     X(0xd0) X(0xef) X(0xaa) X(0xfb) X(0x43) X(0x4d) X(0x33) X(0x85) \
+     X(0x45) X(0xf9) X(0x02) X(0x7f) X(0x50) X(0x3c) X(0x9f) X(0xa8) \
+     X(0x51) X(0xa3) X(0x40) X(0x8f) X(0x92) X(0x9d) X(0x38) X(0xf5) \
+     X(0xbc) X(0xb6) X(0xda) X(0x21) X(0x10) X(0xff) X(0xf3) X(0xd2) \
+     X(0xcd) X(0x0c) X(0x13) X(0xec) X(0x5f) X(0x97) X(0x44) X(0x17) \
+     X(0xc4) X(0xa7) X(0x7e) X(0x3d) X(0x64) X(0x5d) X(0x19) X(0x73) \
+     X(0x60) X(0x81) X(0x4f) X(0xdc) X(0x22) X(0x2a) X(0x90) X(0x88) \
+     X(0x46) X(0xee) X(0xb8) X(0x14) X(0xde) X(0x5e) X(0x0b) X(0xdb) \
+     X(0xe0) X(0x32) X(0x3a) X(0x0a) X(0x49) X(0x06) X(0x24) X(0x5c) \
+     X(0xc2) X(0xd3) X(0xac) X(0x62) X(0x91) X(0x95) X(0xe4) X(0x79) \
+     X(0xe7) X(0xc8) X(0x37) X(0x6d) X(0x8d) X(0xd5) X(0x4e) X(0xa9) \
+     X(0x6c) X(0x56) X(0xf4) X(0xea) X(0x65) X(0x7a) X(0xae) X(0x08) \
+     X(0xba) X(0x78) X(0x25) X(0x2e) X(0x1c) X(0xa6) X(0xb4) X(0xc6) \
+     X(0xe8) X(0xdd) X(0x74) X(0x1f) X(0x4b) X(0xbd) X(0x8b) X(0x8a) \
+     X(0x70) X(0x3e) X(0xb5) X(0x66) X(0x48) X(0x03) X(0xf6) X(0x0e) \
+     X(0x61) X(0x35) X(0x57) X(0xb9) X(0x86) X(0xc1) X(0x1d) X(0x9e) \
+     X(0xe1) X(0xf8) X(0x98) X(0x11) X(0x69) X(0xd9) X(0x8e) X(0x94) \
+     X(0x9b) X(0x1e) X(0x87) X(0xe9) X(0xce) X(0x55) X(0x28) X(0xdf) \
+     X(0x8c) X(0xa1) X(0x89) X(0x0d) X(0xbf) X(0xe6) X(0x42) X(0x68) \
+     X(0x41) X(0x99) X(0x2d) X(0x0f) X(0xb0) X(0x54) X(0xbb) X(0x16)
+
+ #define SBOX_BYTE(v) v,
+ static const uint8_t sbox[256] = { SBOX_VALUES(SBOX_BYTE) };
+
+ #if TC_AES_TTABLE
+ /*
+  * T0[x] = (2.S[x], S[x], S[x], 3.S[x]) as a big-endian column: one lookup
+  * does sub_bytes and mix_columns for one byte. T1..T3 are T0 rotated by
+  * 8, 16 and 24 bits; with TC_AES_TTABLE == 1 only T0 is stored (1 KB of
+  * flash) and the rotations are done at run time, with 4 all four (4 KB).
+  * Table lookups are indexed by secret data: use only on parts without a
+  * data cache (nRF51) or where cache-timing leaks do not matter.
+  */
+ #define XT(v) ((((v) << 1) ^ (((v) >> 7) * 0x1b)) & 0xff)
+ #define TE0(v) (((uint32_t)XT(v) << 24) | ((uint32_t)(v) << 16) | \
+                 ((uint32_t)(v) << 8) | (uint32_t)(XT(v) ^ (v)))
+ #define ROR(w, n) (((w) >> (n)) | ((w) << (32 - (n))))
+ #define TE0_ENTRY(v) TE0(v),
+ static const uint32_t T0[256] = { SBOX_VALUES(TE0_ENTRY) };
+ #if TC_AES_TTABLE == 4
+ #define TE1_ENTRY(v) ROR(TE0(v), 8),
+ #define TE2_ENTRY(v) ROR(TE0(v), 16),
+ #define TE3_ENTRY(v) ROR(TE0(v), 24),
+ static const uint32_t T1[256] = { SBOX_VALUES(TE1_ENTRY) };
+ static const uint32_t T2[256] = { SBOX_VALUES(TE2_ENTRY) };
+ static const uint32_t T3[256] = { SBOX_VALUES(TE3_ENTRY) };
+ #define TE1(x) T1[x]
+ #define TE2(x) T2[x]
+ #define TE3(x) T3[x]
+ #else
+ #define TE1(x) ROR(T0[x], 8)
+ #define TE2(x) ROR(T0[x], 16)
+ #define TE3(x) ROR(T0[x], 24)
+ #endif
+ #endif /* TC_AES_TTABLE */
  
  static inline unsigned int rotword(unsigned int a)
  {
@@ -98,6 +146,70 @@
      return TC_CRYPTO_SUCCESS;
  }
  
+ #if TC_AES_TTABLE
+
+ static inline uint32_t load_be32(const uint8_t *p)
+ {
+     return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+            ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+ }
+
+ static inline void store_be32(uint8_t *p, uint32_t v)
+ {
+     p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16);
+     p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+ }
+
+ /* shift_rows is folded into the column each byte is taken from */
+ #define TROUND(a, b, c, d, k) \
+     (T0[(a) >> 24] ^ TE1(((b) >> 16) & 0xff) ^ TE2(((c) >> 8) & 0xff) ^ \
+      TE3((d) & 0xff) ^ (k))
+ #define FROUND(a, b, c, d, k) \
+     ((((uint32_t)sbox[(a) >> 24] << 24) | \
+       ((uint32_t)sbox[((b) >> 16) & 0xff] << 16) | \
+       ((uint32_t)sbox[((c) >> 8) & 0xff] << 8) | \
+       (uint32_t)sbox[(d) & 0xff]) ^ (k))
+
+ int tc_aes_encrypt(uint8_t *out, const uint8_t *in, const TCAesKeySched_t s)
+ {
+     const unsigned int *k;
+     uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+     unsigned int i;
+
+     if (out == (uint8_t *) 0) {
+         return TC_CRYPTO_FAIL;
+     } else if (in == (const uint8_t *) 0) {
+         return TC_CRYPTO_FAIL;
+     } else if (s == (TCAesKeySched_t) 0) {
+         return TC_CRYPTO_FAIL;
+     }
+
+     k = s->words;
+     s0 = load_be32(in) ^ k[0];
+     s1 = load_be32(in + 4) ^ k[1];
+     s2 = load_be32(in + 8) ^ k[2];
+     s3 = load_be32(in + 12) ^ k[3];
+
+     for (i = 1; i < Nr; ++i) {
+         k += Nb;
+         t0 = TROUND(s0, s1, s2, s3, k[0]);
+         t1 = TROUND(s1, s2, s3, s0, k[1]);
+         t2 = TROUND(s2, s3, s0, s1, k[2]);
+         t3 = TROUND(s3, s0, s1, s2, k[3]);
+         s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+     }
+
+     k += Nb;
+     store_be32(out, FROUND(s0, s1, s2, s3, k[0]));
+     store_be32(out + 4, FROUND(s1, s2, s3, s0, k[1]));
+     store_be32(out + 8, FROUND(s2, s3, s0, s1, k[2]));
+     store_be32(out + 12, FROUND(s3, s0, s1, s2, k[3]));
+
+     return TC_CRYPTO_SUCCESS;
+ }
+
+ #else /* !TC_AES_TTABLE */
+
  static inline void add_round_key(uint8_t *s, const unsigned int *k)
  {
      s[0] ^= (uint8_t)(k[0] >> 24); s[1] ^= (uint8_t)(k[0] >> 16);
@@ -188,4 +300,6 @@
      _set(state, TC_ZERO_BYTE, sizeof(state));
  
      return TC_CRYPTO_SUCCESS;
- }
\ No newline at end of file
+ }
+
+ #endif /* TC_AES_TTABLE */
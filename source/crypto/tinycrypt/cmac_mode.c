@@ -179,8 +179,12 @@ int tc_cmac_update(TCCmacState_t s, const uint8_t *data, size_t data_length)
 		/* last data added to s didn't end on a TC_AES_BLOCK_SIZE byte boundary */
 		size_t remaining_space = TC_AES_BLOCK_SIZE - s->leftover_offset;
 
-		if (data_length < remaining_space) {
-			/* still not enough data to encrypt this time either */
+		if (data_length <= remaining_space) {
+			/*
+			 * still not enough data to encrypt this time either; a block
+			 * filled exactly is kept too, since it may be the last one and
+			 * tc_cmac_final must then apply K1 to it
+			 */
 			_copy(&s->leftover[s->leftover_offset], data_length, data, data_length);
 			s->leftover_offset += data_length;
 			return TC_CRYPTO_SUCCESS;
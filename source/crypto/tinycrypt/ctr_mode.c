@@ -82,4 +82,64 @@
      ctr[14] = nonce[14]; ctr[15] = nonce[15];
  
      return TC_CRYPTO_SUCCESS;
- }
\ No newline at end of file
+ }
+
+ int tc_ctr_stream_init(TCCtrStream_t s, const uint8_t *ctr,
+                        const TCAesKeySched_t sched)
+ {
+     if (s == (TCCtrStream_t) 0 ||
+         ctr == (const uint8_t *) 0 ||
+         sched == (TCAesKeySched_t) 0) {
+         return TC_CRYPTO_FAIL;
+     }
+
+     s->sched = sched;
+     (void)_copy(s->ctr, sizeof(s->ctr), ctr, sizeof(s->ctr));
+     s->offset = TC_AES_BLOCK_SIZE; /* no keystream yet */
+
+     return TC_CRYPTO_SUCCESS;
+ }
+
+ int tc_ctr_stream_crypt(TCCtrStream_t s, uint8_t *out, const uint8_t *in,
+                         unsigned int len)
+ {
+     unsigned int block_num;
+     unsigned int i, n;
+
+     if (s == (TCCtrStream_t) 0) {
+         return TC_CRYPTO_FAIL;
+     } else if (len > 0 && (out == (uint8_t *) 0 || in == (const uint8_t *) 0)) {
+         return TC_CRYPTO_FAIL;
+     }
+
+     while (len > 0) {
+         if (s->offset == TC_AES_BLOCK_SIZE) {
+             /* keystream exhausted: next block, as tc_ctr_mode does */
+             if (!tc_aes_encrypt(s->keystream, s->ctr, s->sched)) {
+                 return TC_CRYPTO_FAIL;
+             }
+             block_num = (s->ctr[12] << 24) | (s->ctr[13] << 16) |
+                     (s->ctr[14] << 8) | (s->ctr[15]);
+             block_num++;
+             s->ctr[12] = (uint8_t)(block_num >> 24);
+             s->ctr[13] = (uint8_t)(block_num >> 16);
+             s->ctr[14] = (uint8_t)(block_num >> 8);
+             s->ctr[15] = (uint8_t)(block_num);
+             s->offset = 0;
+         }
+         /* use what is left of the current block */
+         n = TC_AES_BLOCK_SIZE - s->offset;
+         if (n > len) {
+             n = len;
+         }
+         for (i = 0; i < n; ++i) {
+             out[i] = in[i] ^ s->keystream[s->offset + i];
+         }
+         s->offset += n;
+         out += n;
+         in += n;
+         len -= n;
+     }
+
+     return TC_CRYPTO_SUCCESS;
+ }
@@ -61,6 +61,26 @@ extern "C" {
 #define TC_AES_BLOCK_SIZE (Nb*Nk)
 #define TC_AES_KEY_SIZE (Nb*Nk)
 
+/*
+ * Encryption backend, fixed at compile time:
+ *   0 -- byte-wise reference rounds (smallest flash footprint, default)
+ *   1 -- 32-bit column rounds with one 1 KB T-table
+ *   4 -- 32-bit column rounds with four 1 KB T-tables (fastest)
+ * Set with the yotta config key "tinycrypt.aes_ttable" or -DTC_AES_TTABLE.
+ * The key schedule format is the same for all backends.
+ */
+#ifndef TC_AES_TTABLE
+#ifdef YOTTA_CFG_TINYCRYPT_AES_TTABLE
+#define TC_AES_TTABLE YOTTA_CFG_TINYCRYPT_AES_TTABLE
+#else
+#define TC_AES_TTABLE 0
+#endif
+#endif
+
+#if TC_AES_TTABLE != 0 && TC_AES_TTABLE != 1 && TC_AES_TTABLE != 4
+#error "TC_AES_TTABLE must be 0, 1 or 4"
+#endif
+
 typedef struct tc_aes_key_sched_struct {
 	unsigned int words[Nb*(Nr+1)];
 } *TCAesKeySched_t;
@@ -62,6 +62,10 @@
  *
  *  Usage:     1) call tc_ctr_mode to process the data to encrypt/decrypt.
  *
+ *             or, for data arriving in pieces:
+ *             1) call tc_ctr_stream_init once with the initial counter.
+ *             2) call tc_ctr_stream_crypt for each piece, of any length.
+ *
  */
 
 #ifndef __TC_CTR_MODE_H__
@@ -101,6 +105,42 @@ extern "C" {
 int tc_ctr_mode(uint8_t *out, unsigned int outlen, const uint8_t *in,
 		unsigned int inlen, uint8_t *ctr, const TCAesKeySched_t sched);
 
+/* struct tc_ctr_stream_struct keeps CTR state between calls */
+typedef struct tc_ctr_stream_struct {
+	TCAesKeySched_t sched; /* AES key schedule */
+	uint8_t ctr[TC_AES_BLOCK_SIZE]; /* next counter block to encrypt */
+	uint8_t keystream[TC_AES_BLOCK_SIZE]; /* current keystream block */
+	unsigned int offset; /* keystream bytes already used */
+} *TCCtrStream_t;
+
+/**
+ *  @brief Starts a streaming CTR computation
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if: s, ctr or sched is NULL
+ *  @param s OUT -- streaming state
+ *  @param ctr IN -- initial counter value (same format as tc_ctr_mode)
+ *  @param sched IN -- an initialized AES key schedule, kept by reference
+ */
+int tc_ctr_stream_init(TCCtrStream_t s, const uint8_t *ctr,
+		       const TCAesKeySched_t sched);
+
+/**
+ *  @brief Encrypts (or decrypts) the next len bytes of the stream
+ *  The unused part of the last keystream block is kept for the next call,
+ *  so processing a message in pieces gives the same output as a single
+ *  tc_ctr_mode call, with no extra AES block.
+ *  @return returns TC_CRYPTO_SUCCESS (1)
+ *          returns TC_CRYPTO_FAIL (0) if: s is NULL or
+ *                (len > 0 and (out == NULL or in == NULL))
+ *  @note out and in may be the same buffer
+ *  @param s IN/OUT -- streaming state
+ *  @param out OUT -- produced ciphertext (plaintext)
+ *  @param in IN -- data to encrypt (or decrypt)
+ *  @param len IN -- number of bytes, may be 0
+ */
+int tc_ctr_stream_crypt(TCCtrStream_t s, uint8_t *out, const uint8_t *in,
+			unsigned int len);
+
 #ifdef __cplusplus
 }
 #endif
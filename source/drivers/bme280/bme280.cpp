@@ -23,44 +23,113 @@
 
 
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <errno.h>
 
 #include "bme280.h"
 
 
 /* Sensor config
- * Performs configuration of the sensor and recovers calibration data from sensor's internal
- *   memory.
+ * Performs configuration of the sensor and recovers calibration data from MicroBitStorage,
+ *   or from sensor's internal memory on first boot (then stored for the next ones).
  * Return value:
  *   Upon successfull completion, returns 0. On error, returns a negative integer
  *   equivalent to errors from glibc.
  */
-#define CONF_BUF_SIZE 6
-bme280::bme280(MicroBit* uB, MicroBitI2C* uBi2c, uint8_t addr, uint8_t humidity_os, uint8_t temp_os,
+bme280::bme280(MicroBit* uB, i2c_queue* uBi2c, uint8_t addr, uint8_t humidity_os, uint8_t temp_os,
                 uint8_t pressure_os, uint8_t sensor_mode, uint8_t standby, uint8_t coeff)
                 :
-                uBit(uB), i2c(uBi2c), address(addr), probe_ok(0), humidity_oversampling(humidity_os), temp_oversampling(temp_os), pressure_oversampling(pressure_os), mode(sensor_mode), standby_len(standby), filter_coeff(coeff) 
+                uBit(uB), i2c(uBi2c), address(addr), probe_ok(0), chip_id(0), humidity_oversampling(humidity_os), temp_oversampling(temp_os), pressure_oversampling(pressure_os), mode(sensor_mode), standby_len(standby), filter_coeff(coeff),
+                pressure_comp(BME280_PRESSURE_32BIT)
 {
-    int ret = 0;
-    char cmd_buf[CONF_BUF_SIZE] = {
-        BME280_REGS(ctrl_humidity), (uint8_t)BME280_CTRL_HUM(humidity_oversampling),
-        BME280_REGS(ctrl_measure),  (uint8_t)BME280_CTRL_MEA(pressure_oversampling, temp_oversampling, mode),
-        BME280_REGS(config), (uint8_t)BME280_CONFIG(standby_len, filter_coeff),
-    };
-
     if (probe_sensor() != 1) {
         probe_ok = 0;
         uBit->display.scroll("No Device");
     }
     /* Send the configuration */
-    ret = i2c->write(address, cmd_buf, CONF_BUF_SIZE);
+    if (write_config() != MICROBIT_OK) {
+        uBit->display.scroll("Conf Error");
+    }
+    /* Get the calibration data : from the storage on warm boots, else from the sensor */
+    if (load_calibration_data() != MICROBIT_OK) {
+        struct bme280_calibration_image img;
+        if (get_calibration_data(&img) != MICROBIT_OK) {
+            uBit->display.scroll("Calibration Error");
+        } else {
+            parse_calibration_data(&img);
+            store_calibration_data(&img);
+        }
+    }
+}
+
+
+/* Send the configuration held in the members
+ * All registers in a single write transaction : the sensor is first put to sleep (config
+ *   writes are ignored in normal mode), ctrl_humidity only takes effect after the
+ *   ctrl_measure write, hence ctrl_measure again, last, with the requested mode.
+ */
+#define CONF_BUF_SIZE 8
+int bme280::write_config()
+{
+    char cmd_buf[CONF_BUF_SIZE] = {
+        BME280_REGS(ctrl_measure),  (uint8_t)BME280_CTRL_MEA(pressure_oversampling, temp_oversampling, BME280_SLEEP),
+        BME280_REGS(ctrl_humidity), (uint8_t)BME280_CTRL_HUM(humidity_oversampling),
+        BME280_REGS(config), (uint8_t)BME280_CONFIG(standby_len, filter_coeff),
+        BME280_REGS(ctrl_measure),  (uint8_t)BME280_CTRL_MEA(pressure_oversampling, temp_oversampling, mode),
+    };
+
+    int ret = i2c->write(address, cmd_buf, CONF_BUF_SIZE);
     if (ret != MICROBIT_OK) {
         probe_ok = 0;
-        uBit->display.scroll("Conf Error");
     }
-    /* Get the calibration data */
-    if (get_calibration_data() != MICROBIT_OK)
-      uBit->display.scroll("Calibration Error");
+    return ret;
+}
+
+/* Sampling profiles, from the datasheet recommended modes of operation (section 3.5).
+ * Weather and low-power both convert once a second at x1 : the former is triggered by the
+ *   MCU (forced), the latter is self-timed (normal mode, 1 s standby), without trigger nor
+ *   status polling on the bus.
+ */
+struct bme280_profile {
+    uint8_t humidity_os;
+    uint8_t temp_os;
+    uint8_t pressure_os;
+    uint8_t mode;
+    uint8_t standby;
+    uint8_t filter;
+};
+
+static const struct bme280_profile bme280_profiles[BME280_NB_PROFILES] = {
+    /* BME280_PROFILE_WEATHER : lowest power per sample, no filter */
+    { BME280_OS_x1, BME280_OS_x1, BME280_OS_x1,  BME280_SLEEP,  BME280_SB_1000ms, BME280_FILT_OFF },
+    /* BME280_PROFILE_INDOOR : lowest noise (indoor navigation) */
+    { BME280_OS_x1, BME280_OS_x2, BME280_OS_x16, BME280_NORMAL, BME280_SB_05ms,   BME280_FILT_16 },
+    /* BME280_PROFILE_FAST_RESPONSE : short conversions, light filtering */
+    { BME280_OS_x1, BME280_OS_x1, BME280_OS_x4,  BME280_NORMAL, BME280_SB_05ms,   BME280_FILT_2 },
+    /* BME280_PROFILE_LOW_POWER : self-timed at 1 Hz */
+    { BME280_OS_x1, BME280_OS_x1, BME280_OS_x1,  BME280_NORMAL, BME280_SB_1000ms, BME280_FILT_OFF },
+};
+
+int bme280::configure(uint8_t humidity_os, uint8_t temp_os, uint8_t pressure_os, uint8_t sensor_mode,
+                        uint8_t standby, uint8_t coeff)
+{
+    humidity_oversampling = humidity_os;
+    temp_oversampling = temp_os;
+    pressure_oversampling = pressure_os;
+    mode = sensor_mode;
+    standby_len = standby;
+    filter_coeff = coeff;
+    return write_config();
+}
+
+int bme280::set_profile(uint8_t profile)
+{
+    if (profile >= BME280_NB_PROFILES) {
+        return MICROBIT_INVALID_PARAMETER;
+    }
+    const struct bme280_profile* p = &bme280_profiles[profile];
+    return configure(p->humidity_os, p->temp_os, p->pressure_os, p->mode, p->standby, p->filter);
 }
 
 
@@ -73,8 +142,8 @@ int bme280::probe_sensor()
 
     /* Did we already probe the sensor ? */
     if (probe_ok != 1) {
-        i2c->write(address, cmd_buf,1,true);
-        int ret = i2c->read(address, (char*)&id, 1);
+        int ret = i2c->write_read(address, cmd_buf, 1, (char*)&id, 1);
+        chip_id = (ret == MICROBIT_OK) ? id : 0;
         if (ret == MICROBIT_OK && id != BME280_ID) {
             probe_ok = 0;
         } else {
@@ -88,77 +157,121 @@ int bme280::probe_sensor()
 /* Get calibration data from internal sensor memory
  * These values are required to compute the pressure, temperature and humidity values
  *   from the uncompensated "raw" values read from the sensor ADC result registers.
- * Calibration data for pressure and temperature is aligned, packed, and in little
- *    endian byte order, so it is stored directly to the cal structure.
- * Calibration data for humidity is split among different registers and not aligned,
- *    so we use a temporary data buffer.
- * Note : On the LPC822 the I2C bus requires some time to go idle, so we need to
- *    sleep some time between two conscutive I2C access.
- *    this should be done in the I2C driver, but is not yet implemented, so it is
- *    done here. These msleep() calls may be removed for other micro-controllers, and
- *    when the I2C driver for the LPC822 is imporved.
+ * Calibration data lies in two register ranges, 0x88 .. 0xA1 and 0xE1 .. 0xE7, each one
+ *   read in a single burst (reading 0x88 .. 0xE7 at once would move 63 useless bytes).
+ * The raw image is kept as is so that it can be stored, see parse_calibration_data().
  * Return value:
  *   Upon successfull completion, returns 0. On error, returns a negative integer
  *   equivalent to errors from glibc.
  */
 #define CAL_CMD_SIZE  1
-int bme280::get_calibration_data()
+int bme280::get_calibration_data(struct bme280_calibration_image* img)
 {
     int ret = 0;
     char cmd_buf[CAL_CMD_SIZE] = { BME280_CAL_REGS(T)};
+    uint8_t data[BME280_CAL_BURST_LEN];
 
-    /* Give some time for I2C bus to go idle */
-    uBit->sleep(1);
-    /* Easy part : Temperature and Presure calibration data is packed, aligned, and
-     *   in little endian byte order */
-    /* Start by reading temperature calibration data */
-    i2c->write(address,cmd_buf,1,true);
-    ret = i2c->read(address, (char*)&(cal.T1), BME280_CAL_REGS_T_LEN);
-    if (ret != MICROBIT_OK) {
-        probe_ok = 0;
-        return ret;
-    }
-    uBit->sleep(1); /* Again some time for I2C bus to go idle */
-    /* Read pressure calibration data */
-    cmd_buf[0] = BME280_CAL_REGS(P);
-    i2c->write(address,cmd_buf,1,true);
-    ret = i2c->read(address, (char*)&(cal.P1), BME280_CAL_REGS_P_LEN);
+    /* First burst : temperature, pressure, then H1 after one reserved byte */
+    ret = i2c->write_read(address, cmd_buf, 1, (char*)data, BME280_CAL_BURST_LEN);
     if (ret != MICROBIT_OK) {
         probe_ok = 0;
         return ret;
     }
-    uBit->sleep(1); /* ... */
-
-    /* Read humidity calibration data. This one is split among bytes and not aligned. use
-     *   temporary data buffer and then copy to calibration structure. */
-    /* First part */
-    uint8_t data[BME280_CAL_REGS_H_LEN];
+    memcpy(img->tp, data, BME280_CAL_REGS_TP_LEN);
+    img->h[0] = data[BME280_CAL_BURST_LEN - 1];
 
-    cmd_buf[0] = BME280_CAL_REGS(Ha);
-    i2c->write(address,cmd_buf,1,true);
-    ret = i2c->read(address, (char*)data, BME280_CAL_REGS_Ha_LEN);
-    if (ret != MICROBIT_OK) {
-        probe_ok = 0;
-        return ret;
-    }
-    uBit->sleep(1); /* ... */
-    /* Second part */
+    /* Second burst : the remaining, unaligned humidity data */
     cmd_buf[0] = BME280_CAL_REGS(Hb);
-    i2c->write(address,cmd_buf,1,true);
-    ret = i2c->read(address, (char*)data+BME280_CAL_REGS_Ha_LEN, BME280_CAL_REGS_Hb_LEN);
+    ret = i2c->write_read(address, cmd_buf, 1, (char*)img->h + BME280_CAL_REGS_Ha_LEN, BME280_CAL_REGS_Hb_LEN);
     if (ret != MICROBIT_OK) {
         probe_ok = 0;
         return ret;
     }
-    /* And store in calibration structure */
+    return MICROBIT_OK;
+}
+
+/* Fill the calibration structure from the raw image.
+ * Temperature and Presure calibration data is packed, aligned, and in little endian byte
+ *   order, so it is copied directly to the cal structure.
+ * Calibration data for humidity is split among different registers and not aligned.
+ */
+void bme280::parse_calibration_data(const struct bme280_calibration_image* img)
+{
+    const uint8_t* data = img->h;
+
+    memcpy(&cal.T1, img->tp, BME280_CAL_REGS_TP_LEN);
     cal.H1 = data[0];
     cal.H2 = ((data[1] & 0xFF) | ((data[2] & 0xFF) << 8));
     cal.H3 = data[3];
     cal.H4 = (((data[4] & 0xFF) << 4) | (data[5] & 0x0F));
     cal.H5 = (((data[6] & 0xFF) << 4) | ((data[5] & 0xF0) >> 4));
     cal.H6 = data[7];
+}
 
-    return MICROBIT_OK;
+/* The image must fit in a single storage value */
+typedef char bme280_cal_image_fits[
+    (sizeof(struct bme280_calibration_image) <= MICROBIT_STORAGE_VALUE_SIZE) ? 1 : -1];
+
+/* Storage key for this sensor : address and chip id, e.g. "bme280_EC60" */
+void bme280::calibration_key(char* key)
+{
+    snprintf(key, MICROBIT_STORAGE_KEY_SIZE, "bme280_%02X%02X", address, chip_id);
+}
+
+/* Load the calibration cached in MicroBitStorage by a previous boot.
+ * The key only holds the address and chip id (the same for all BME280), so the cached
+ *   image is checked against the sensor first : the temperature trimming words
+ *   (BME280_CAL_CHECK_LEN bytes at 0x88) differ from part to part, a replaced sensor
+ *   does not match and gets its calibration read again.
+ * Return value:
+ *   MICROBIT_OK when the calibration structure was filled, MICROBIT_NO_RESOURCES when
+ *   nothing is cached (or the sensor was not identified), MICROBIT_NO_DATA when the cache
+ *   belongs to another part, the I2C is then required. The I2C error on failed check.
+ */
+int bme280::load_calibration_data()
+{
+    char key[MICROBIT_STORAGE_KEY_SIZE];
+    char cmd_buf[CAL_CMD_SIZE] = { BME280_CAL_REGS(T)};
+    uint8_t check[BME280_CAL_CHECK_LEN];
+
+    if (probe_ok != 1 || chip_id != BME280_ID) {
+        return MICROBIT_NO_RESOURCES;
+    }
+    calibration_key(key);
+    KeyValuePair* kv = uBit->storage.get(key);
+    if (kv == NULL) {
+        return MICROBIT_NO_RESOURCES;
+    }
+    const struct bme280_calibration_image* img = (const struct bme280_calibration_image*)kv->value;
+    int ret = i2c->write_read(address, cmd_buf, 1, (char*)check, BME280_CAL_CHECK_LEN);
+    if (ret != MICROBIT_OK) {
+        probe_ok = 0;
+    } else if (memcmp(check, img->tp, BME280_CAL_CHECK_LEN) != 0) {
+        ret = MICROBIT_NO_DATA;
+    } else {
+        parse_calibration_data(img);
+    }
+    delete kv;
+    return ret;
+}
+
+int bme280::store_calibration_data(const struct bme280_calibration_image* img)
+{
+    char key[MICROBIT_STORAGE_KEY_SIZE];
+
+    if (probe_ok != 1 || chip_id != BME280_ID) {
+        return MICROBIT_NO_RESOURCES;
+    }
+    calibration_key(key);
+    return uBit->storage.put(key, (uint8_t*)img, sizeof(*img));
+}
+
+int bme280::clear_calibration_cache()
+{
+    char key[MICROBIT_STORAGE_KEY_SIZE];
+
+    calibration_key(key);
+    return uBit->storage.remove(key);
 }
 
 
@@ -185,8 +298,7 @@ int bme280::sensor_read(uint32_t* pressure, int32_t* temp, uint16_t* hum)
     }
 
     /* Start by reading all data */
-    i2c->write(address,cmd_buf,1,true);
-    ret = i2c->read(address, (char*)data, BME280_DATA_SIZE);
+    ret = i2c->write_read(address, cmd_buf, 1, (char*)data, BME280_DATA_SIZE);
     if (ret != MICROBIT_OK) {
         probe_ok = 0;
         return ret;
@@ -205,100 +317,149 @@ int bme280::sensor_read(uint32_t* pressure, int32_t* temp, uint16_t* hum)
 }
 
 
+/* Oversampling register value to oversampling factor : 0, 1, 2, 4, 8, 16 */
+static uint32_t oversampling_factor(uint8_t os)
+{
+    if (os == BME280_SKIP) {
+        return 0;
+    }
+    if (os > BME280_OS_x16) {
+        os = BME280_OS_x16;
+    }
+    return 1 << (os - 1);
+}
 
-/* Compute actual temperature from uncompensated temperature
- * Param :
- *  - utemp : uncompensated (raw) temperature value read from sensor
- * Returns the value in 0.01 degree Centigrade
- * Output value of "5123" equals 51.23 DegC.
+/* Measurement time from the datasheet, appendix B :
+ *   1.25 + 2.3 * T_os + (2.3 * P_os + 0.575) + (2.3 * H_os + 0.575) ms
+ *   the pressure and humidity terms being 0 when the channel is skipped.
  */
-int bme280::compensate_temperature(int utemp)
+uint32_t bme280::measurement_time_us()
 {
-    int tmp1 = 0, tmp2 = 0;
-    int temperature = 0;
-
-    /* Calculate tmp1 */
-    tmp1 = ((((utemp >> 3) - ((int)cal.T1 << 1))) * cal.T2) >> 11;
-    /* Calculate tmp2 */
-    tmp2 = (((utemp >> 4) - (int)cal.T1) * ((utemp >> 4) - (int)cal.T1)) >> 12;
-    tmp2 = (tmp2 * cal.T3) >> 14;
-    /* Calculate t_fine */
-    fine_temp = tmp1 + tmp2;
-    /* Calculate temperature */
-    temperature = (fine_temp * 5 + 128) >> 8;
-    return temperature;
+    uint32_t t_os = oversampling_factor(temp_oversampling);
+    uint32_t p_os = oversampling_factor(pressure_oversampling);
+    uint32_t h_os = oversampling_factor(humidity_oversampling);
+    uint32_t time = BME280_MEAS_TIME_BASE_US + (BME280_MEAS_TIME_OS_US * t_os);
+
+    if (p_os != 0) {
+        time += (BME280_MEAS_TIME_OS_US * p_os) + BME280_MEAS_TIME_PH_US;
+    }
+    if (h_os != 0) {
+        time += (BME280_MEAS_TIME_OS_US * h_os) + BME280_MEAS_TIME_PH_US;
+    }
+    return time;
 }
 
-/* Compute actual pressure from uncompensated pressure
- * Returns the value in Pascal(Pa) or 0 on error (invalid value which would cause division by 0).
- * Output value of "96386" equals 96386 Pa = 963.86 hPa = 963.86 millibar
- */
-uint32_t bme280::compensate_pressure(int uncomp_pressure)
+#define FORCE_CMD_SIZE  2
+int bme280::start_measurement()
 {
-    int tmp1 = 0, tmp2 = 0, tmp3 = 0;
-    uint32_t pressure = 0;
+    char cmd_buf[FORCE_CMD_SIZE] = {
+        BME280_REGS(ctrl_measure),
+        (uint8_t)BME280_CTRL_MEA(pressure_oversampling, temp_oversampling, BME280_FORCED),
+    };
 
-    /* Calculate tmp1 */
-    tmp1 = (fine_temp >> 1) - 64000;
-    /* Calculate tmp2 */
-    tmp2 = (((tmp1 >> 2) * (tmp1 >> 2)) >> 11) * cal.P6;
-    tmp2 = tmp2 + ((tmp1 * cal.P5) << 1);
-    tmp2 = (tmp2 >> 2) + (cal.P4 << 16);
-    /* Update tmp1 */
-    tmp3 = (cal.P3 * (((tmp1 >> 2) * (tmp1 >> 2)) >> 13)) >> 3;
-    tmp1 = (tmp3 + ((cal.P2 * tmp1) >> 1)) >> 18;
-    tmp1 = (((32768 + tmp1)) * (int)cal.P1) >> 15;
-    /* Calculate pressure */
-    pressure = ((uint32_t)(1048576 - uncomp_pressure) - (tmp2 >> 12)) * 3125;
-
-    /* Avoid exception caused by division by zero */
-    if (tmp1 == 0) {
-        return 0;
+    if (probe_ok != 1) {
+        if (probe_sensor() != 1) {
+            return -1;
+        }
     }
-    if (pressure < 0x80000000) {
-        pressure = (pressure << 1) / ((uint32_t)tmp1);
-    } else {
-        pressure = (pressure / (uint32_t)tmp1) * 2;
+    int ret = i2c->write(address, cmd_buf, FORCE_CMD_SIZE);
+    if (ret != MICROBIT_OK) {
+        probe_ok = 0;
+        return ret;
     }
+    return 0;
+}
 
-    tmp1 = (cal.P9 * ((int)(((pressure >> 3) * (pressure >> 3)) >> 13))) >> 12;
-    tmp2 = (((int)(pressure >> 2)) * cal.P8) >> 13;
-    pressure = (uint32_t)((int)pressure + ((tmp1 + tmp2 + cal.P7) >> 4));
+#define STATUS_CMD_SIZE  1
+int bme280::measuring()
+{
+    char cmd_buf[STATUS_CMD_SIZE] = { BME280_REGS(status)};
+    uint8_t status = 0;
+
+    int ret = i2c->write_read(address, cmd_buf, STATUS_CMD_SIZE, (char*)&status, 1);
+    if (ret != MICROBIT_OK) {
+        probe_ok = 0;
+        return ret;
+    }
+    return (status & BME280_STATUS_MEASURING) ? 1 : 0;
+}
 
-    return pressure;
+int bme280::sensor_read_forced(uint32_t* pressure, int32_t* temp, uint16_t* hum)
+{
+    int ret = start_measurement();
+    if (ret != 0) {
+        return ret;
+    }
+    /* No I2C traffic during the conversion, the fiber simply sleeps */
+    uBit->sleep((measurement_time_us() + 999) / 1000);
+    ret = wait_measurement();
+    if (ret != 0) {
+        return ret;
+    }
+    return sensor_read(pressure, temp, hum);
 }
 
+int bme280::wait_measurement()
+{
+    int ret = 0;
+    for (int i = 0; (ret = measuring()) == 1; i++) {
+        if (i == BME280_POLL_MAX) {
+            return -1;
+        }
+        uBit->sleep(BME280_POLL_PERIOD_MS);
+    }
+    return ret;
+}
 
-/* Compute actual humidity from uncompensated humidity
- * Returns the value in 0.01 %rH
- * Output value of "4132" equals 41.32 %rH.
- */
-uint32_t bme280::compensate_humidity(int uncomp_humidity)
+int bme280::read_compensated(struct bme280_compensated* out)
 {
-    int tmp1 = 0, tmp2 = 0, tmp3 = 0;
-    uint32_t humidity = 0;
-
-    /* Calculate tmp1 */
-    tmp1 = fine_temp - 76800;
-    /* Calculate tmp2 */
-    tmp2 = ((uncomp_humidity << 14) - (cal.H4 << 20) - (cal.H5 * tmp1) + 16384) >> 15;
-    /* Calculate tmp3 */
-    tmp3 = ((((tmp1 * cal.H6) >> 10) * (((tmp1 * (int)cal.H3) >> 11) + 32768)) >> 10) + 2097152;
-    /* Update tmp1 */
-    tmp1 = tmp2 * ((tmp3 * cal.H2 + 8192) >> 14);
-    tmp1 = tmp1 - (((((tmp1 >> 15) * (tmp1 >> 15)) >> 7) * (int)cal.H1) >> 4);
-    if (tmp1 < 0) {
-        tmp1 = 0;
+    uint32_t pressure = 0;
+    int32_t temp = 0;
+    uint16_t hum = 0;
+
+    int ret = sensor_read(&pressure, &temp, &hum);
+    if (ret != 0) {
+        return ret;
     }
-    if (tmp1 > 419430400) {
-        tmp1 = 419430400;
+    bme280_compensate(&cal, pressure, temp, hum, out, pressure_comp);
+    return 0;
+}
+
+
+int bme280::sensor_read_compensated(struct bme280_compensated* out)
+{
+    /* Outside of normal mode the data registers only change after a forced conversion */
+    if (mode != BME280_NORMAL) {
+        int ret = start_measurement();
+        if (ret != 0) {
+            return ret;
+        }
+        uBit->sleep((measurement_time_us() + 999) / 1000);
+        ret = wait_measurement();
+        if (ret != 0) {
+            return ret;
+        }
     }
-    humidity = (uint32_t)(tmp1 >> 12);
-    /* Convert from 32bit integer in Q22.10 format (22 integer 10 fractional bits) to a value
-     *   in 0.01 %rH :
-     * A value of 42313 represents 42313 / 1024 = 41.321 %rH, convert it to 4132, which is 41.32 %rH.
-     */
-    humidity = ((humidity >> 10) * 100) + ((((humidity & 0x3FF) * 1000) >> 10) / 10);
-    return humidity;
+    return read_compensated(out);
+}
 
+
+/* Compensation wrappers over the pure functions of bme280_compensate.h.
+ * compensate_temperature() must be called first : it updates fine_temp, used by the two
+ *   others. sensor_read_compensated() has no such ordering constraint.
+ */
+int bme280::compensate_temperature(int utemp)
+{
+    fine_temp = bme280_compensate_t_fine(&cal, utemp);
+    return bme280_compensate_temperature(fine_temp);
+}
+
+uint32_t bme280::compensate_pressure(int uncomp_pressure)
+{
+    return bme280_compensate_pressure(&cal, fine_temp, uncomp_pressure);
+}
+
+uint32_t bme280::compensate_humidity(int uncomp_humidity)
+{
+    return bme280_compensate_humidity(&cal, fine_temp, uncomp_humidity);
 }
@@ -33,32 +33,12 @@
 
 #include <cstdint>
 #include <MicroBit.h>
+#include "i2c_queue.h"
 
-#define BME280_ADDR 0xEC
+#include "bme280_compensate.h"
 
-struct bme280_calibration_data {
-    /* Temperature */
-    uint16_t T1;   /* 0x88 */
-    int16_t T2;    /* 0x8A */
-    int16_t T3;    /* 0x8C */
-    /* Pressure */
-    uint16_t P1;   /* 0x8E */
-    int16_t P2;    /* 0x90 */
-    int16_t P3;    /* 0x92 */
-    int16_t P4;    /* 0x94 */
-    int16_t P5;    /* 0x96 */
-    int16_t P6;    /* 0x98 */
-    int16_t P7;    /* 0x9A */
-    int16_t P8;    /* 0x9C */
-    int16_t P9;    /* 0x9E */
-    /* Humidity */
-    uint8_t H1;    /* 0xA1 */
-    int16_t H2;    /* 0xE1 .. 0xE2 */
-    uint8_t H3;    /* 0xE3 */
-    int16_t H4;    /* 0xE4 .. 0xE5[3:0] */
-    int16_t H5;    /* 0xE5[7:4] .. 0xE6 */
-    int8_t H6;     /* 0xE7 */
-};
+#define BME280_ADDR      0xEC  /* SDO to GND */
+#define BME280_ADDR_ALT  0xEE  /* SDO to VDDIO */
 
 #define BME280_DATA_SIZE   8
 struct bme280_data {
@@ -85,6 +65,20 @@ struct bme280_calibration_regs {
 #define BME280_CAL_REGS_Ha_LEN  1
 #define BME280_CAL_REGS_Hb_LEN  7
 #define BME280_CAL_REGS_H_LEN   (BME280_CAL_REGS_Ha_LEN + BME280_CAL_REGS_Hb_LEN)
+#define BME280_CAL_REGS_TP_LEN  (BME280_CAL_REGS_T_LEN + BME280_CAL_REGS_P_LEN)
+/* First calibration burst : 0x88 .. 0xA1 (T, P, one reserved byte and H1) */
+#define BME280_CAL_BURST_LEN    (BME280_CAL_REGS_TP_LEN + 1 + BME280_CAL_REGS_Ha_LEN)
+/* Part specific bytes re-read to validate the cached calibration : T1 .. T3 */
+#define BME280_CAL_CHECK_LEN    BME280_CAL_REGS_T_LEN
+
+/* Raw calibration image, as read in two bursts (0x88 .. 0xA1 and 0xE1 .. 0xE7, the 63 bytes
+ *   in between are not calibration data) and as cached in MicroBitStorage.
+ * 32 bytes : exactly one storage value (the parsed structure does not fit).
+ */
+struct bme280_calibration_image {
+    uint8_t tp[BME280_CAL_REGS_TP_LEN];  /* 0x88 .. 0x9F */
+    uint8_t h[BME280_CAL_REGS_H_LEN];    /* 0xA1, 0xE1 .. 0xE7 */
+};
 
 struct bme280_internal_regs {
     uint8_t chip_id;         /* 0xD0 - Value should be 0x60 */
@@ -126,6 +120,25 @@ struct bme280_internal_regs {
     ( (((temp) & 0x07) << 5) | (((pres) & 0x07) << 2) | ((mode) & 0x03) )
 
 
+/* Status register */
+#define BME280_STATUS_MEASURING  (1 << 3)
+#define BME280_STATUS_IM_UPDATE  (1 << 0)
+
+/* Measurement time (datasheet, appendix B, maximum values), in micro-seconds.
+ * 'os' is the oversampling factor (0 when the channel is skipped). */
+#define BME280_MEAS_TIME_BASE_US    1250
+#define BME280_MEAS_TIME_OS_US      2300
+#define BME280_MEAS_TIME_PH_US      575
+/* Status polling after the computed measurement time, see wait_measurement()
+ * uBit->sleep() is rounded up to the DAL scheduler tick (6ms) : poll once per tick. The
+ *   measurement time above already uses the datasheet maximum values, the budget only
+ *   covers the sensor clock spread (about 25% of the longest, x16 oversampling, conversion).
+ */
+#define BME280_POLL_PERIOD_MS       6
+#define BME280_POLL_BUDGET_MS       30
+#define BME280_POLL_MAX             (BME280_POLL_BUDGET_MS / BME280_POLL_PERIOD_MS)
+
+
 /* Standby */
 #define BME280_SB_05ms     0x00
 #define BME280_SB_10ms     0x06
@@ -143,6 +156,13 @@ struct bme280_internal_regs {
 #define BME280_FILT_8      0x03
 #define BME280_FILT_16     0x04
 
+/* Sampling profiles, see bme280::set_profile() */
+#define BME280_PROFILE_WEATHER        0
+#define BME280_PROFILE_INDOOR         1
+#define BME280_PROFILE_FAST_RESPONSE  2
+#define BME280_PROFILE_LOW_POWER      3
+#define BME280_NB_PROFILES            4
+
 /* Config register helper */
 #define BME280_CONFIG(stb, filt)   ( (((stb) & 0x07) << 5) | (((filt) & 0x07) << 2) )
 
@@ -158,13 +178,19 @@ class bme280 {
          * Performs configuration of the sensor and recovers calibration data from sensor's internal
          *   memory.
          */
-        bme280(MicroBit* uB, MicroBitI2C* uBi2c, uint8_t addr = BME280_ADDR, uint8_t humidity_oversampling = BME280_OS_x16,
+        bme280(MicroBit* uB, i2c_queue* uBi2c, uint8_t addr = BME280_ADDR, uint8_t humidity_oversampling = BME280_OS_x16,
                 uint8_t temp_oversampling = BME280_OS_x16, uint8_t pressure_oversampling = BME280_OS_x16, uint8_t mode = BME280_NORMAL,
                 uint8_t standby_len = BME280_SB_62ms, uint8_t filter_coeff = BME280_FILT_OFF);
 
         /* Check the sensor presence, return 1 if found */
         int probe_sensor();
 
+        /* Remove the calibration cached in MicroBitStorage for this address and chip id.
+         * A replaced sensor is detected at construction (the cache is checked against its
+         *   temperature trimming words), this only forces the next boot to read it again.
+         */
+        int clear_calibration_cache();
+
         /* Humidity, Temperature and Pressure Read
          * Performs a read of the data from the sensor.
          * 'hum', 'temp' and 'pressure': integer addresses for conversion result.
@@ -176,9 +202,91 @@ class bme280 {
         int sensor_read(uint32_t* pressure, int32_t* temp, uint16_t* hum);
 
 
+        /* Measurement time of one forced conversion with the configured oversampling, in
+         *   micro-seconds (maximum value from the datasheet).
+         */
+        uint32_t measurement_time_us();
+
+        /* Start a single conversion (forced mode). The sensor goes back to sleep once done.
+         * Return value:
+         *   Upon successfull completion, returns 0. On error, returns a negative integer.
+         */
+        int start_measurement();
+
+        /* Read the status register.
+         * Returns 1 while a conversion is running, 0 when the results are available, or a
+         *   negative integer on error.
+         */
+        int measuring();
+
+        /* Forced mode read
+         * Starts a conversion, sleeps (fiber) for the measurement time, then polls the status
+         *   register until the conversion is done and reads the results as sensor_read() does.
+         * Must be called from a fiber : other fibers (display, radio) run meanwhile.
+         * Use with mode = BME280_SLEEP (or BME280_FORCED) at construction.
+         */
+        int sensor_read_forced(uint32_t* pressure, int32_t* temp, uint16_t* hum);
+
+        /* Poll the status register until the running conversion is over (at most
+         *   BME280_POLL_MAX times, one scheduler tick apart : BME280_POLL_BUDGET_MS).
+         * Return value:
+         *   Upon successfull completion, returns 0. On error or timeout, returns a negative
+         *   integer.
+         */
+        int wait_measurement();
+
+        /* Read and compensate the results of the last conversion, without starting a new one.
+         * Used to run the conversions of several sensors at the same time : start_measurement()
+         *   on each one, sleep once, then wait_measurement() and read_compensated().
+         * Return value:
+         *   Upon successfull completion, returns 0 and fills 'out'. On error, returns a negative
+         *   integer.
+         */
+        int read_compensated(struct bme280_compensated* out);
+
+        /* Configured mode : BME280_NORMAL (self-timed), or BME280_SLEEP / BME280_FORCED
+         *   (one conversion per start_measurement())
+         */
+        uint8_t sampling_mode() const { return mode; }
+
+        /* Compensated read
+         * Reads the three raw values in one burst (after a forced conversion unless the sensor
+         *   is in normal mode) and compensates them with the pure functions of
+         *   bme280_compensate.h : no call order, no state shared between calls.
+         * Return value:
+         *   Upon successfull completion, returns 0 and fills 'out'. On error, returns a negative
+         *   integer.
+         */
+        int sensor_read_compensated(struct bme280_compensated* out);
+
+        /* Runtime reconfiguration
+         * Changes oversampling, mode, standby and filter in one I2C write. The calibration
+         *   data is kept, nothing is read back.
+         * Return value:
+         *   Upon successfull completion, returns 0. On error, returns a negative integer.
+         */
+        int configure(uint8_t humidity_oversampling, uint8_t temp_oversampling, uint8_t pressure_oversampling,
+                uint8_t mode, uint8_t standby_len, uint8_t filter_coeff);
+
+        /* Apply one of the BME280_PROFILE_* sampling profiles (see configure()) */
+        int set_profile(uint8_t profile);
+
+        /* Select the pressure compensation used by sensor_read_compensated() :
+         *   BME280_PRESSURE_32BIT (default, 1 Pa steps) or BME280_PRESSURE_64BIT (Q24.8 Pa,
+         *   costlier 64-bit arithmetic). See 'make bme280-pressure-bench' for the trade-off.
+         */
+        void set_pressure_compensation(uint8_t pressure_mode) { pressure_comp = pressure_mode; }
+
+        /* Calibration data read from the sensor (or from the storage), for the pure
+         *   compensation functions.
+         */
+        const struct bme280_calibration_data* calibration() const { return &cal; }
+
+
         /* Compute actual temperature from uncompensated temperature
+         * Also updates the t_fine used by compensate_pressure() and compensate_humidity(),
+         *   which must be called after it (see sensor_read_compensated() instead).
          * Param :
-         *  - conf : bme280_sensor_configuration structure, with calibration data read from sensor
          *  - utemp : uncompensated (raw) temperature value read from sensor
          * Returns the value in 0.01 degree Centigrade
          * Output value of "5123" equals 51.23 DegC.
@@ -201,19 +309,26 @@ class bme280 {
 
     private:
 
-        int get_calibration_data();
+        int write_config();
+        int get_calibration_data(struct bme280_calibration_image* img);
+        void parse_calibration_data(const struct bme280_calibration_image* img);
+        int load_calibration_data();
+        int store_calibration_data(const struct bme280_calibration_image* img);
+        void calibration_key(char* key);
 
 
         MicroBit* uBit;
-        MicroBitI2C* i2c;
+        i2c_queue* i2c;
         uint8_t address;
         uint8_t probe_ok;
+        uint8_t chip_id;
         uint8_t humidity_oversampling;
         uint8_t temp_oversampling;
         uint8_t pressure_oversampling;
         uint8_t mode;
         uint8_t standby_len;
         uint8_t filter_coeff;
+        uint8_t pressure_comp;
         struct bme280_calibration_data cal;
         int fine_temp;
 
@@ -0,0 +1,275 @@
+/****************************************************************************
+ *   bme280_compensate.cpp
+ *
+ * BME280 compensation formulas, without any I2C or MicroBit dependency
+ *
+ * Copyright 2016 Nathael Pajani <nathael.pajani@ed3l.fr>
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *************************************************************************** */
+
+
+#include <cstdint>
+
+#include "bme280_compensate.h"
+
+
+/* Compute t_fine from uncompensated temperature
+ * Param :
+ *  - cal : calibration data read from sensor
+ *  - utemp : uncompensated (raw) temperature value read from sensor
+ */
+int32_t bme280_compensate_t_fine(const struct bme280_calibration_data* cal, int32_t utemp)
+{
+    int tmp1 = 0, tmp2 = 0;
+
+    /* Calculate tmp1 */
+    tmp1 = ((((utemp >> 3) - ((int)cal->T1 << 1))) * cal->T2) >> 11;
+    /* Calculate tmp2 */
+    tmp2 = (((utemp >> 4) - (int)cal->T1) * ((utemp >> 4) - (int)cal->T1)) >> 12;
+    tmp2 = (tmp2 * cal->T3) >> 14;
+    /* Calculate t_fine */
+    return tmp1 + tmp2;
+}
+
+/* Compute actual temperature from t_fine
+ * Returns the value in 0.01 degree Centigrade
+ * Output value of "5123" equals 51.23 DegC.
+ */
+int32_t bme280_compensate_temperature(int32_t t_fine)
+{
+    return (t_fine * 5 + 128) >> 8;
+}
+
+/* Compute actual pressure from uncompensated pressure
+ * Returns the value in Pascal(Pa) or 0 on error (invalid value which would cause division by 0).
+ * Output value of "96386" equals 96386 Pa = 963.86 hPa = 963.86 millibar
+ */
+uint32_t bme280_compensate_pressure(const struct bme280_calibration_data* cal, int32_t t_fine,
+                                    int32_t uncomp_pressure)
+{
+    int tmp1 = 0, tmp2 = 0, tmp3 = 0;
+    uint32_t pressure = 0;
+
+    /* Calculate tmp1 */
+    tmp1 = (t_fine >> 1) - 64000;
+    /* Calculate tmp2 */
+    tmp2 = (((tmp1 >> 2) * (tmp1 >> 2)) >> 11) * cal->P6;
+    tmp2 = tmp2 + ((tmp1 * cal->P5) << 1);
+    tmp2 = (tmp2 >> 2) + (cal->P4 << 16);
+    /* Update tmp1 */
+    tmp3 = (cal->P3 * (((tmp1 >> 2) * (tmp1 >> 2)) >> 13)) >> 3;
+    tmp1 = (tmp3 + ((cal->P2 * tmp1) >> 1)) >> 18;
+    tmp1 = (((32768 + tmp1)) * (int)cal->P1) >> 15;
+    /* Calculate pressure */
+    pressure = ((uint32_t)(1048576 - uncomp_pressure) - (tmp2 >> 12)) * 3125;
+
+    /* Avoid exception caused by division by zero */
+    if (tmp1 == 0) {
+        return 0;
+    }
+    if (pressure < 0x80000000) {
+        pressure = (pressure << 1) / ((uint32_t)tmp1);
+    } else {
+        pressure = (pressure / (uint32_t)tmp1) * 2;
+    }
+
+    tmp1 = (cal->P9 * ((int)(((pressure >> 3) * (pressure >> 3)) >> 13))) >> 12;
+    tmp2 = (((int)(pressure >> 2)) * cal->P8) >> 13;
+    pressure = (uint32_t)((int)pressure + ((tmp1 + tmp2 + cal->P7) >> 4));
+
+    return pressure;
+}
+
+
+/* Compute actual pressure from uncompensated pressure, 64-bit version
+ * Returns the value in Pa as unsigned 32 bit integer in Q24.8 format (24 integer bits and
+ *   8 fractional bits), or 0 on error (invalid value which would cause division by 0).
+ * Output value of "24674867" represents 24674867/256 = 96386.2 Pa = 963.862 hPa
+ */
+uint32_t bme280_compensate_pressure_q24_8(const struct bme280_calibration_data* cal,
+                                          int32_t t_fine, int32_t uncomp_pressure)
+{
+    int64_t tmp1 = 0, tmp2 = 0, pressure = 0;
+
+    /* Calculate tmp1 and tmp2 */
+    tmp1 = ((int64_t)t_fine) - 128000;
+    tmp2 = tmp1 * tmp1 * (int64_t)cal->P6;
+    tmp2 = tmp2 + ((tmp1 * (int64_t)cal->P5) * 131072);
+    tmp2 = tmp2 + (((int64_t)cal->P4) * 34359738368);
+    /* Update tmp1 */
+    tmp1 = ((tmp1 * tmp1 * (int64_t)cal->P3) >> 8) + ((tmp1 * (int64_t)cal->P2) * 4096);
+    tmp1 = (((((int64_t)1) << 47) + tmp1) * ((int64_t)cal->P1)) >> 33;
+
+    /* Avoid exception caused by division by zero */
+    if (tmp1 == 0) {
+        return 0;
+    }
+    /* Calculate pressure */
+    pressure = 1048576 - uncomp_pressure;
+    pressure = (((pressure * 2147483648) - tmp2) * 3125) / tmp1;
+    tmp1 = (((int64_t)cal->P9) * (pressure >> 13) * (pressure >> 13)) >> 25;
+    tmp2 = (((int64_t)cal->P8) * pressure) >> 19;
+    pressure = ((pressure + tmp1 + tmp2) >> 8) + (((int64_t)cal->P7) * 16);
+
+    return (uint32_t)pressure;
+}
+
+
+/* Compute actual humidity from uncompensated humidity
+ * Returns the value in 0.01 %rH
+ * Output value of "4132" equals 41.32 %rH.
+ */
+uint32_t bme280_compensate_humidity(const struct bme280_calibration_data* cal, int32_t t_fine,
+                                    int32_t uncomp_humidity)
+{
+    int tmp1 = 0, tmp2 = 0, tmp3 = 0;
+    uint32_t humidity = 0;
+
+    /* Calculate tmp1 */
+    tmp1 = t_fine - 76800;
+    /* Calculate tmp2 */
+    tmp2 = ((uncomp_humidity << 14) - (cal->H4 << 20) - (cal->H5 * tmp1) + 16384) >> 15;
+    /* Calculate tmp3 */
+    tmp3 = ((((tmp1 * cal->H6) >> 10) * (((tmp1 * (int)cal->H3) >> 11) + 32768)) >> 10) + 2097152;
+    /* Update tmp1 */
+    tmp1 = tmp2 * ((tmp3 * cal->H2 + 8192) >> 14);
+    tmp1 = tmp1 - (((((tmp1 >> 15) * (tmp1 >> 15)) >> 7) * (int)cal->H1) >> 4);
+    if (tmp1 < 0) {
+        tmp1 = 0;
+    }
+    if (tmp1 > 419430400) {
+        tmp1 = 419430400;
+    }
+    humidity = (uint32_t)(tmp1 >> 12);
+    /* Convert from 32bit integer in Q22.10 format (22 integer 10 fractional bits) to a value
+     *   in 0.01 %rH :
+     * A value of 42313 represents 42313 / 1024 = 41.321 %rH, convert it to 4132, which is 41.32 %rH.
+     */
+    humidity = ((humidity >> 10) * 100) + ((((humidity & 0x3FF) * 1000) >> 10) / 10);
+    return humidity;
+}
+
+
+void bme280_compensate(const struct bme280_calibration_data* cal, uint32_t uncomp_pressure,
+                       int32_t uncomp_temp, uint16_t uncomp_humidity,
+                       struct bme280_compensated* out, uint8_t pressure_mode)
+{
+    int32_t t_fine = bme280_compensate_t_fine(cal, uncomp_temp);
+
+    out->temperature = bme280_compensate_temperature(t_fine);
+    if (pressure_mode == BME280_PRESSURE_64BIT) {
+        out->pressure_q8 = bme280_compensate_pressure_q24_8(cal, t_fine, (int32_t)uncomp_pressure);
+        out->pressure = out->pressure_q8 >> 8;
+    } else {
+        out->pressure = bme280_compensate_pressure(cal, t_fine, (int32_t)uncomp_pressure);
+        out->pressure_q8 = out->pressure << 8;
+    }
+    out->humidity = bme280_compensate_humidity(cal, t_fine, uncomp_humidity);
+}
+
+
+/* Batch compensation
+ * Same integer formulas as above, with the branches turned into selects so that one loop
+ *   iteration has no control flow. The 32-bit unsigned division has no SIMD instruction :
+ *   it is done on doubles, then corrected in integers (see div_u32).
+ * On x86_64 hosts an AVX2 clone is built next to the default one and picked at load time.
+ */
+#if defined(__x86_64__) && defined(__ELF__) && defined(__GNUC__)
+#define BME280_BATCH_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define BME280_BATCH_CLONES
+#endif
+
+static inline double u32_to_double(uint32_t x)
+{
+    /* signed conversion only : vectorizable without AVX-512 */
+    return (double)(int32_t)(x ^ 0x80000000) + 2147483648.0;
+}
+
+/* Floor of num / den, with num < 2^32 and 0 < den < 2^32.
+ * The double quotient is converted through the signed range : the conversion truncates
+ *   toward zero and the shift rounds, so the candidate is the exact quotient or one more.
+ *   One 64-bit product settles it.
+ */
+static inline uint32_t div_u32(uint32_t num, uint32_t den)
+{
+    double q = u32_to_double(num) / u32_to_double(den);
+    uint32_t quot = (uint32_t)(int32_t)(q - 2147483648.0) ^ 0x80000000;
+    return quot - ((uint64_t)quot * den > num);
+}
+
+BME280_BATCH_CLONES
+void bme280_compensate_batch(const struct bme280_calibration_data* cal,
+                             const struct bme280_raw_batch* in,
+                             struct bme280_compensated_batch* out, size_t n)
+{
+    const uint32_t* __restrict__ up = in->pressure;
+    const int32_t* __restrict__ ut = in->temperature;
+    const uint16_t* __restrict__ uh = in->humidity;
+    int32_t* __restrict__ t_out = out->temperature;
+    uint32_t* __restrict__ p_out = out->pressure;
+    uint32_t* __restrict__ h_out = out->humidity;
+
+    /* calibration in locals : no reload through the pointers inside the loop */
+    const int T1 = cal->T1, T2 = cal->T2, T3 = cal->T3;
+    const int P1 = cal->P1, P2 = cal->P2, P3 = cal->P3, P4 = cal->P4, P5 = cal->P5;
+    const int P6 = cal->P6, P7 = cal->P7, P8 = cal->P8, P9 = cal->P9;
+    const int H1 = cal->H1, H2 = cal->H2, H3 = cal->H3, H4 = cal->H4, H5 = cal->H5;
+    const int H6 = cal->H6;
+
+    for (size_t i = 0; i < n; i++) {
+        int utemp = ut[i];
+        int tmp1, tmp2, tmp3;
+
+        /* Temperature */
+        tmp1 = ((((utemp >> 3) - (T1 << 1))) * T2) >> 11;
+        tmp2 = (((utemp >> 4) - T1) * ((utemp >> 4) - T1)) >> 12;
+        tmp2 = (tmp2 * T3) >> 14;
+        int t_fine = tmp1 + tmp2;
+        t_out[i] = (t_fine * 5 + 128) >> 8;
+
+        /* Pressure */
+        tmp1 = (t_fine >> 1) - 64000;
+        tmp2 = (((tmp1 >> 2) * (tmp1 >> 2)) >> 11) * P6;
+        tmp2 = tmp2 + ((tmp1 * P5) << 1);
+        tmp2 = (tmp2 >> 2) + (P4 << 16);
+        tmp3 = (P3 * (((tmp1 >> 2) * (tmp1 >> 2)) >> 13)) >> 3;
+        tmp1 = (tmp3 + ((P2 * tmp1) >> 1)) >> 18;
+        tmp1 = (((32768 + tmp1)) * P1) >> 15;
+        uint32_t pressure = ((uint32_t)(1048576 - (int)up[i]) - (tmp2 >> 12)) * 3125;
+        uint32_t divisor = (uint32_t)tmp1 | (tmp1 == 0); /* result discarded when 0 */
+        /* (p << 1) / d if p < 2^31, else (p / d) * 2 : shifts instead of branches,
+         *   the conversions then stay unconditional */
+        uint32_t big = pressure >> 31;
+        pressure = div_u32(pressure << (1 - big), divisor) << big;
+        tmp3 = (P9 * ((int)(((pressure >> 3) * (pressure >> 3)) >> 13))) >> 12;
+        tmp2 = (((int)(pressure >> 2)) * P8) >> 13;
+        pressure = (uint32_t)((int)pressure + ((tmp3 + tmp2 + P7) >> 4));
+        p_out[i] = pressure & (0 - (uint32_t)(tmp1 != 0)); /* 0 on division by zero */
+
+        /* Humidity */
+        tmp1 = t_fine - 76800;
+        tmp2 = (((int)uh[i] << 14) - (H4 << 20) - (H5 * tmp1) + 16384) >> 15;
+        tmp3 = ((((tmp1 * H6) >> 10) * (((tmp1 * H3) >> 11) + 32768)) >> 10) + 2097152;
+        tmp1 = tmp2 * ((tmp3 * H2 + 8192) >> 14);
+        tmp1 = tmp1 - (((((tmp1 >> 15) * (tmp1 >> 15)) >> 7) * H1) >> 4);
+        tmp1 = tmp1 < 0 ? 0 : tmp1;
+        tmp1 = tmp1 > 419430400 ? 419430400 : tmp1;
+        uint32_t humidity = (uint32_t)(tmp1 >> 12);
+        h_out[i] = ((humidity >> 10) * 100) + ((((humidity & 0x3FF) * 1000) >> 10) / 10);
+    }
+}
@@ -0,0 +1,138 @@
+/****************************************************************************
+ *   bme280_compensate.h
+ *
+ * BME280 compensation formulas, without any I2C or MicroBit dependency
+ *
+ * Copyright 2016 Nathael Pajani <nathael.pajani@ed3l.fr>
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *************************************************************************** */
+
+/**
+ * The functions below are pure : the calibration data and t_fine are explicit
+ *   parameters, so they are reentrant and can be used on the host (gateway replay,
+ *   benchmarks) as well as by the bme280 driver.
+ */
+
+#ifndef BME280_COMPENSATE_H
+#define BME280_COMPENSATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct bme280_calibration_data {
+    /* Temperature */
+    uint16_t T1;   /* 0x88 */
+    int16_t T2;    /* 0x8A */
+    int16_t T3;    /* 0x8C */
+    /* Pressure */
+    uint16_t P1;   /* 0x8E */
+    int16_t P2;    /* 0x90 */
+    int16_t P3;    /* 0x92 */
+    int16_t P4;    /* 0x94 */
+    int16_t P5;    /* 0x96 */
+    int16_t P6;    /* 0x98 */
+    int16_t P7;    /* 0x9A */
+    int16_t P8;    /* 0x9C */
+    int16_t P9;    /* 0x9E */
+    /* Humidity */
+    uint8_t H1;    /* 0xA1 */
+    int16_t H2;    /* 0xE1 .. 0xE2 */
+    uint8_t H3;    /* 0xE3 */
+    int16_t H4;    /* 0xE4 .. 0xE5[3:0] */
+    int16_t H5;    /* 0xE5[7:4] .. 0xE6 */
+    int8_t H6;     /* 0xE7 */
+};
+
+/* Pressure compensation paths */
+#define BME280_PRESSURE_32BIT  0   /* datasheet 32-bit integer formula, 1 Pa steps */
+#define BME280_PRESSURE_64BIT  1   /* datasheet 64-bit integer formula, Q24.8 Pa */
+
+/* Compensated values of one measurement */
+struct bme280_compensated {
+    int32_t temperature;   /* 0.01 degree Centigrade */
+    uint32_t pressure;     /* Pa */
+    uint32_t pressure_q8;  /* Q24.8 Pa (1/256 Pa), pressure << 8 with the 32-bit path */
+    uint32_t humidity;     /* 0.01 %rH */
+};
+
+/* Structure of arrays of raw values, as read from the data registers */
+struct bme280_raw_batch {
+    const uint32_t* pressure;
+    const int32_t* temperature;
+    const uint16_t* humidity;
+};
+
+/* Structure of arrays of compensated values (same units as bme280_compensated) */
+struct bme280_compensated_batch {
+    int32_t* temperature;
+    uint32_t* pressure;
+    uint32_t* humidity;
+};
+
+
+/* Compute t_fine (fine resolution temperature, shared by the three formulas) from
+ *   the uncompensated (raw) temperature value read from sensor.
+ */
+int32_t bme280_compensate_t_fine(const struct bme280_calibration_data* cal, int32_t utemp);
+
+/* Temperature from t_fine, in 0.01 degree Centigrade.
+ * Output value of "5123" equals 51.23 DegC.
+ */
+int32_t bme280_compensate_temperature(int32_t t_fine);
+
+/* Pressure from uncompensated pressure and t_fine.
+ * Returns the value in Pascal(Pa) or 0 on error (invalid value which would cause division by 0).
+ * Output value of "96386" equals 96386 Pa = 963.86 hPa = 963.86 millibar
+ */
+uint32_t bme280_compensate_pressure(const struct bme280_calibration_data* cal, int32_t t_fine,
+                                    int32_t uncomp_pressure);
+
+/* Pressure from uncompensated pressure and t_fine, 64-bit path.
+ * Returns the value in Q24.8 format, in Pascal (24 integer and 8 fractional bits), or 0 on
+ *   error. Output value of "24674867" represents 24674867 / 256 = 96386.2 Pa.
+ * Uses 64-bit multiplications and a 64-bit division, done in software on the Cortex-M0
+ *   of the micro:bit.
+ */
+uint32_t bme280_compensate_pressure_q24_8(const struct bme280_calibration_data* cal,
+                                          int32_t t_fine, int32_t uncomp_pressure);
+
+/* Humidity from uncompensated humidity and t_fine.
+ * Returns the value in 0.01 %rH
+ * Output value of "4132" equals 41.32 %rH.
+ */
+uint32_t bme280_compensate_humidity(const struct bme280_calibration_data* cal, int32_t t_fine,
+                                    int32_t uncomp_humidity);
+
+/* All three values from one set of raw values.
+ * 'pressure_mode' : BME280_PRESSURE_32BIT or BME280_PRESSURE_64BIT.
+ */
+void bme280_compensate(const struct bme280_calibration_data* cal, uint32_t uncomp_pressure,
+                       int32_t uncomp_temp, uint16_t uncomp_humidity,
+                       struct bme280_compensated* out,
+                       uint8_t pressure_mode = BME280_PRESSURE_32BIT);
+
+/* Batch compensation of n raw measurements, for replaying recorded streams on the host.
+ * Branch-free version of the formulas above, written so that the compiler vectorizes it
+ *   (the pressure division goes through doubles, with an integer correction). Results are
+ *   bit-exact with bme280_compensate() (32-bit pressure path) for every input.
+ * The output arrays must not overlap the input ones.
+ */
+void bme280_compensate_batch(const struct bme280_calibration_data* cal,
+                             const struct bme280_raw_batch* in,
+                             struct bme280_compensated_batch* out, size_t n);
+
+#endif /* BME280_COMPENSATE_H */
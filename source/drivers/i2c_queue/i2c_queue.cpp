@@ -0,0 +1,239 @@
+/****************************************************************************
+ * i2c_queue.cpp
+ *
+ * Queued I2C transaction engine shared by the sensor and display drivers
+ *
+ * Copyright 2026 Mathis LAMBERT
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *************************************************************************** */
+
+#include <cstdint>
+#include <cstring>
+
+#include "i2c_queue.h"
+
+
+i2c_queue::i2c_queue(MicroBitI2C* uBi2c)
+    :
+        i2c(uBi2c), next_id(I2C_QUEUE_EVT_FIRST_ID), started(0), idle(0)
+{
+    for (int i = 0; i < I2C_NB_PRIO; i++) {
+        head[i] = NULL;
+        tail[i] = NULL;
+    }
+}
+
+int i2c_queue::start()
+{
+    if (started) {
+        return 0;
+    }
+    if (create_fiber(engine_entry, this) == NULL) {
+        return MICROBIT_NO_RESOURCES;
+    }
+    started = 1;
+    return 0;
+}
+
+bool i2c_queue::running()
+{
+    return (started && fiber_scheduler_running());
+}
+
+
+/* Queue a transaction
+ * Transactions of a given priority are served in submission order.
+ */
+int i2c_queue::submit(struct i2c_xfer* xfer)
+{
+    if ((xfer == NULL) || (xfer->priority >= I2C_NB_PRIO)) {
+        return MICROBIT_INVALID_PARAMETER;
+    }
+    if ((xfer->wlen == 0 && xfer->rlen == 0) || (xfer->chunked && xfer->rlen != 0)) {
+        return MICROBIT_INVALID_PARAMETER;
+    }
+    if (xfer->state == I2C_XFER_QUEUED) {
+        return MICROBIT_BUSY;
+    }
+    xfer->status = MICROBIT_OK;
+    xfer->done = 0;
+    xfer->next = NULL;
+    xfer->id = next_id++;
+    if (next_id < I2C_QUEUE_EVT_FIRST_ID) {
+        next_id = I2C_QUEUE_EVT_FIRST_ID;
+    }
+
+    /* No engine : plain blocking access in the caller context */
+    if (!running()) {
+        while (step(xfer) > 0);
+        complete(xfer);
+        return 0;
+    }
+
+    xfer->state = I2C_XFER_QUEUED;
+    if (tail[xfer->priority] == NULL) {
+        head[xfer->priority] = xfer;
+    } else {
+        tail[xfer->priority]->next = xfer;
+    }
+    tail[xfer->priority] = xfer;
+
+    if (idle) {
+        MicroBitEvent(I2C_QUEUE_ID, I2C_QUEUE_EVT_SUBMIT);
+    }
+    return 0;
+}
+
+int i2c_queue::wait(struct i2c_xfer* xfer)
+{
+    while (xfer->state != I2C_XFER_DONE) {
+        fiber_wait_for_event(I2C_QUEUE_ID, xfer->id);
+    }
+    return xfer->status;
+}
+
+
+/* Blocking helpers */
+int i2c_queue::write(uint8_t address, const char* buf, int len, uint8_t priority)
+{
+    return write_read(address, buf, len, NULL, 0, priority);
+}
+
+int i2c_queue::write_read(uint8_t address, const char* wbuf, int wlen, char* rbuf, int rlen,
+                            uint8_t priority)
+{
+    struct i2c_xfer xfer;
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.address = address;
+    xfer.priority = priority;
+    xfer.wbuf = wbuf;
+    xfer.wlen = wlen;
+    xfer.rbuf = rbuf;
+    xfer.rlen = rlen;
+
+    int ret = submit(&xfer);
+    if (ret != 0) {
+        return ret;
+    }
+    return wait(&xfer);
+}
+
+int i2c_queue::write_chunked(uint8_t address, uint8_t prefix, const char* buf, int len,
+                            uint8_t priority)
+{
+    struct i2c_xfer xfer;
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.address = address;
+    xfer.priority = priority;
+    xfer.chunked = 1;
+    xfer.prefix = prefix;
+    xfer.wbuf = buf;
+    xfer.wlen = len;
+
+    int ret = submit(&xfer);
+    if (ret != 0) {
+        return ret;
+    }
+    return wait(&xfer);
+}
+
+
+/* Engine internals */
+void i2c_queue::engine_entry(void* param)
+{
+    ((i2c_queue*)param)->engine();
+}
+
+/* Oldest transaction of the highest non empty priority, left in the queue */
+struct i2c_xfer* i2c_queue::pop()
+{
+    for (int i = 0; i < I2C_NB_PRIO; i++) {
+        if (head[i] != NULL) {
+            return head[i];
+        }
+    }
+    return NULL;
+}
+
+/* Perform one bus transfer of the transaction
+ * Return value:
+ *   1 if chunks remain to be sent, 0 when the transaction is over (xfer->status set).
+ */
+int i2c_queue::step(struct i2c_xfer* xfer)
+{
+    int ret = 0;
+
+    if (xfer->chunked) {
+        char chunk[1 + I2C_CHUNK_SIZE];
+        uint16_t len = xfer->wlen - xfer->done;
+        if (len > I2C_CHUNK_SIZE) {
+            len = I2C_CHUNK_SIZE;
+        }
+        chunk[0] = xfer->prefix;
+        memcpy(chunk + 1, xfer->wbuf + xfer->done, len);
+        ret = i2c->write(xfer->address, chunk, len + 1);
+        xfer->done += len;
+        if (ret == MICROBIT_OK && xfer->done < xfer->wlen) {
+            return 1;
+        }
+    } else if (xfer->rlen == 0) {
+        ret = i2c->write(xfer->address, xfer->wbuf, xfer->wlen);
+    } else {
+        if (xfer->wlen != 0) {
+            ret = i2c->write(xfer->address, xfer->wbuf, xfer->wlen, true);
+        }
+        if (ret == MICROBIT_OK) {
+            ret = i2c->read(xfer->address, xfer->rbuf, xfer->rlen);
+        }
+    }
+    xfer->status = ret;
+    return 0;
+}
+
+void i2c_queue::complete(struct i2c_xfer* xfer)
+{
+    xfer->state = I2C_XFER_DONE;
+    if (xfer->callback != NULL) {
+        xfer->callback(xfer, xfer->arg);
+    }
+    if (running()) {
+        MicroBitEvent(I2C_QUEUE_ID, xfer->id);
+    }
+}
+
+void i2c_queue::engine()
+{
+    while (true) {
+        struct i2c_xfer* xfer = pop();
+        if (xfer == NULL) {
+            idle = 1;
+            fiber_wait_for_event(I2C_QUEUE_ID, I2C_QUEUE_EVT_SUBMIT);
+            idle = 0;
+            continue;
+        }
+        if (step(xfer) > 0) {
+            /* Let the other fibers run, and maybe submit a sensor access, between chunks */
+            schedule();
+            continue;
+        }
+        head[xfer->priority] = xfer->next;
+        if (head[xfer->priority] == NULL) {
+            tail[xfer->priority] = NULL;
+        }
+        complete(xfer);
+    }
+}
@@ -0,0 +1,142 @@
+/****************************************************************************
+ * i2c_queue.h
+ *
+ * Queued I2C transaction engine shared by the sensor and display drivers
+ *
+ * Copyright 2026 Mathis LAMBERT
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *************************************************************************** */
+
+#ifndef I2C_QUEUE_H
+#define I2C_QUEUE_H
+
+#include <cstdint>
+#include <MicroBit.h>
+
+/* The DAL I2C calls are blocking (busy wait on the TWI peripheral), so a single
+ *   transfer can not be interrupted. The engine gets the latency down by keeping all
+ *   the bus traffic in one fiber, serving high priority transactions first, and
+ *   splitting bulk writes (OLED framebuffer) in small chunks : a sensor read never
+ *   waits more than one chunk (about 3ms at 100kHz) behind a framebuffer push.
+ */
+
+/* Event bus component ID used for the engine notifications */
+#define I2C_QUEUE_ID            9210
+#define I2C_QUEUE_EVT_SUBMIT    1
+#define I2C_QUEUE_EVT_FIRST_ID  2
+
+/* Transaction priorities, lower is served first */
+#define I2C_PRIO_HIGH   0  /* Sensors : short register accesses */
+#define I2C_PRIO_LOW    1  /* Bulk transfers : framebuffer */
+#define I2C_NB_PRIO     2
+
+/* Bulk writes are sent as (prefix byte + I2C_CHUNK_SIZE data bytes) transfers */
+#define I2C_CHUNK_SIZE  32
+
+/* Transaction states */
+#define I2C_XFER_IDLE     0
+#define I2C_XFER_QUEUED   1
+#define I2C_XFER_DONE     2
+
+
+struct i2c_xfer;
+typedef void (*i2c_xfer_cb)(struct i2c_xfer* xfer, void* arg);
+
+/* I2C transaction
+ * The write part is sent first, then the read part (if rlen is not 0) after a
+ *   repeated start, so that no other transaction gets between the register
+ *   selection and the register read.
+ * When 'chunked' is set, the write part is split in chunks of I2C_CHUNK_SIZE bytes,
+ *   each sent in its own transfer starting with the 'prefix' byte. The read part is
+ *   not allowed in this case.
+ * The structure (and the buffers) belong to the engine from submit() until the
+ *   state is I2C_XFER_DONE.
+ */
+struct i2c_xfer {
+    uint8_t address;
+    uint8_t priority;
+    uint8_t chunked;
+    uint8_t prefix;
+    const char* wbuf;
+    uint16_t wlen;
+    char* rbuf;
+    uint16_t rlen;
+    i2c_xfer_cb callback; /* Called from the engine fiber on completion, may be NULL */
+    void* arg;
+    /* Filled by the engine */
+    volatile uint8_t state;
+    int status;    /* MICROBIT_OK or the error of the failed transfer */
+    uint16_t id;   /* Completion event value */
+    uint16_t done; /* Bytes of wbuf already sent (chunked writes) */
+    struct i2c_xfer* next;
+};
+
+
+class i2c_queue {
+    public:
+        i2c_queue(MicroBitI2C* uBi2c);
+
+        /* Start the engine fiber
+         * Until then (and whenever the fiber scheduler is not running), transactions are
+         *   performed in the caller context, as a plain blocking I2C access.
+         * Return value:
+         *   Upon successfull completion, returns 0. On error, returns a negative integer.
+         */
+        int start();
+
+        /* Queue a transaction, completion is reported through the callback and
+         *   the (I2C_QUEUE_ID, xfer->id) event.
+         * Return value:
+         *   Upon successfull completion, returns 0. On error, returns a negative integer.
+         */
+        int submit(struct i2c_xfer* xfer);
+
+        /* Wait for the end of a submitted transaction, only the calling fiber sleeps.
+         * Return value:
+         *   The transaction status.
+         */
+        int wait(struct i2c_xfer* xfer);
+
+        /* Blocking helpers for the drivers, the calling fiber sleeps until completion
+         * Return value:
+         *   Upon successfull completion, returns MICROBIT_OK. On error, returns the DAL
+         *   I2C error code.
+         */
+        int write(uint8_t address, const char* buf, int len, uint8_t priority = I2C_PRIO_HIGH);
+        int write_read(uint8_t address, const char* wbuf, int wlen, char* rbuf, int rlen,
+                        uint8_t priority = I2C_PRIO_HIGH);
+        /* Chunked write, see struct i2c_xfer */
+        int write_chunked(uint8_t address, uint8_t prefix, const char* buf, int len,
+                        uint8_t priority = I2C_PRIO_LOW);
+
+    private:
+        static void engine_entry(void* param);
+        void engine();
+        bool running();
+        struct i2c_xfer* pop();
+        int step(struct i2c_xfer* xfer);
+        void complete(struct i2c_xfer* xfer);
+
+        MicroBitI2C* i2c;
+        struct i2c_xfer* head[I2C_NB_PRIO];
+        struct i2c_xfer* tail[I2C_NB_PRIO];
+        uint16_t next_id;
+        uint8_t started;
+        volatile uint8_t idle;
+};
+
+#endif /* I2C_QUEUE_H */
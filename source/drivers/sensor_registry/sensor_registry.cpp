@@ -0,0 +1,150 @@
+/****************************************************************************
+ * sensor_registry.cpp
+ *
+ * Discovery and grouped sampling of the BME280 and TSL256x sensors of one I2C bus
+ *
+ * Copyright 2026 Mathis LAMBERT
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *************************************************************************** */
+
+#include <cstdint>
+#include <cstring>
+
+#include "sensor_registry.h"
+
+static const uint8_t bme280_addresses[SENSOR_MAX_ENV] = { BME280_ADDR, BME280_ADDR_ALT };
+static const uint8_t tsl256x_addresses[SENSOR_MAX_LIGHT] = {
+    TSL256x_ADDR_LOW, TSL256x_ADDR_FLOAT, TSL256x_ADDR_HIGH,
+};
+
+
+sensor_registry::sensor_registry(MicroBit* uB, i2c_queue* bus)
+    :
+        uBit(uB), i2c(bus), nb_bme(0), nb_tsl(0)
+{
+    memset(bme, 0, sizeof(bme));
+    memset(tsl, 0, sizeof(tsl));
+}
+
+
+/* Probe all the addresses
+ * The presence is checked here with a single register read, before creating the
+ *   driver : the driver constructors report missing devices on the display.
+ */
+int sensor_registry::discover(uint8_t oversampling, uint8_t mode)
+{
+    char cmd = 0;
+    uint8_t id = 0;
+
+    for (int i = 0; i < SENSOR_MAX_ENV && nb_bme < SENSOR_MAX_ENV; i++) {
+        cmd = BME280_REGS(chip_id);
+        if (i2c->write_read(bme280_addresses[i], &cmd, 1, (char*)&id, 1) != MICROBIT_OK) {
+            continue;
+        }
+        if (id != BME280_ID) {
+            continue;
+        }
+        bme[nb_bme++] = new bme280(uBit, i2c, bme280_addresses[i], oversampling, oversampling,
+                                    oversampling, mode);
+    }
+    for (int i = 0; i < SENSOR_MAX_LIGHT && nb_tsl < SENSOR_MAX_LIGHT; i++) {
+        cmd = TSL256x_CMD(part_id);
+        if (i2c->write_read(tsl256x_addresses[i], &cmd, 1, (char*)&id, 1) != MICROBIT_OK) {
+            continue;
+        }
+        if (!TSL256x_PART_VALID(id)) {
+            continue;
+        }
+        tsl[nb_tsl++] = new tsl256x(uBit, i2c, tsl256x_addresses[i]);
+    }
+    return nb_bme + nb_tsl;
+}
+
+
+int sensor_registry::sample(struct sensor_point* points, int max)
+{
+    uint8_t started[SENSOR_MAX_ENV] = { 0 };
+    uint32_t wait_us = 0;
+    int nb = nb_points();
+
+    if (nb > max) {
+        nb = max;
+    }
+    memset(points, 0, nb * sizeof(struct sensor_point));
+    for (int i = 0; i < nb; i++) {
+        points[i].env = SENSOR_NONE;
+        points[i].light = SENSOR_NONE;
+    }
+
+    /* Start all the forced conversions at once */
+    for (int i = 0; i < nb_bme; i++) {
+        if (bme[i]->sampling_mode() == BME280_NORMAL) {
+            started[i] = 1;
+            continue;
+        }
+        if (bme[i]->start_measurement() == 0) {
+            uint32_t time = bme[i]->measurement_time_us();
+            started[i] = 1;
+            if (time > wait_us) {
+                wait_us = time;
+            }
+        }
+    }
+
+    /* The TSL256x are read during the conversions */
+    for (int i = 0; i < nb_tsl && i < nb; i++) {
+        if (tsl[i]->sensor_read(&points[i].comb, &points[i].ir, &points[i].lux) == 0) {
+            points[i].light = i;
+        }
+    }
+
+    if (wait_us != 0) {
+        uBit->sleep((wait_us + 999) / 1000);
+    }
+    for (int i = 0; i < nb_bme && i < nb; i++) {
+        if (!started[i]) {
+            continue;
+        }
+        if (bme[i]->sampling_mode() != BME280_NORMAL && bme[i]->wait_measurement() != 0) {
+            continue;
+        }
+        if (bme[i]->read_compensated(&points[i].env_data) == 0) {
+            points[i].env = i;
+        }
+    }
+    return nb;
+}
+
+
+int sensor_registry::set_profile(uint8_t profile)
+{
+    int ret = 0;
+    for (int i = 0; i < nb_bme; i++) {
+        int err = bme[i]->set_profile(profile);
+        if (err != 0) {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+void sensor_registry::set_pressure_compensation(uint8_t pressure_mode)
+{
+    for (int i = 0; i < nb_bme; i++) {
+        bme[i]->set_pressure_compensation(pressure_mode);
+    }
+}
@@ -0,0 +1,101 @@
+/****************************************************************************
+ * sensor_registry.h
+ *
+ * Discovery and grouped sampling of the BME280 and TSL256x sensors of one I2C bus
+ *
+ * Copyright 2026 Mathis LAMBERT
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *************************************************************************** */
+
+#ifndef SENSOR_REGISTRY_H
+#define SENSOR_REGISTRY_H
+
+#include <cstdint>
+#include <MicroBit.h>
+#include "i2c_queue.h"
+#include "bme280.h"
+#include "tsl256x.h"
+
+/* Every address each part can be strapped to */
+#define SENSOR_MAX_ENV     2  /* BME280 : BME280_ADDR, BME280_ADDR_ALT */
+#define SENSOR_MAX_LIGHT   3  /* TSL256x : TSL256x_ADDR_LOW, _FLOAT, _HIGH */
+#define SENSOR_MAX_POINTS  SENSOR_MAX_LIGHT
+
+/* No sensor of this kind for a measurement point (or its read failed) */
+#define SENSOR_NONE  0x0F
+
+/* Measurement point
+ * Point i groups the i-th BME280 and the i-th TSL256x found (discovery order is the
+ *   address order), there are as many points as sensors of the most represented kind.
+ * 'env' and 'light' are the sensor indexes, SENSOR_NONE when the values are not valid.
+ */
+struct sensor_point {
+    uint8_t env;
+    uint8_t light;
+    struct bme280_compensated env_data;
+    uint16_t comb;
+    uint16_t ir;
+    uint32_t lux;
+};
+
+
+class sensor_registry {
+    public:
+        sensor_registry(MicroBit* uB, i2c_queue* bus);
+
+        /* Probe all the addresses, and create a driver for each device that answers with
+         *   the right identification. The BME280 get the given oversampling on the three
+         *   channels and the given mode.
+         * Return value:
+         *   The number of sensors found.
+         */
+        int discover(uint8_t oversampling = BME280_OS_x16, uint8_t mode = BME280_SLEEP);
+
+        uint8_t nb_env() const { return nb_bme; }
+        uint8_t nb_light() const { return nb_tsl; }
+        uint8_t nb_points() const { return (nb_bme > nb_tsl) ? nb_bme : nb_tsl; }
+        bme280* env(uint8_t i) { return (i < nb_bme) ? bme[i] : NULL; }
+        tsl256x* light(uint8_t i) { return (i < nb_tsl) ? tsl[i] : NULL; }
+
+        /* Sample all the sensors in one pass
+         * The forced conversions of all the BME280 are started together and the calling
+         *   fiber sleeps once, for the longest of them. The TSL256x integrate continuously
+         *   and are read meanwhile.
+         * Return value:
+         *   The number of points filled in 'points' (at most 'max').
+         */
+        int sample(struct sensor_point* points, int max);
+
+        /* Settings applied to every BME280, see bme280::set_profile() and
+         *   bme280::set_pressure_compensation()
+         * Return value:
+         *   Upon successfull completion, returns 0. On error, returns the error of the last
+         *   failed sensor.
+         */
+        int set_profile(uint8_t profile);
+        void set_pressure_compensation(uint8_t pressure_mode);
+
+    private:
+        MicroBit* uBit;
+        i2c_queue* i2c;
+        bme280* bme[SENSOR_MAX_ENV];
+        tsl256x* tsl[SENSOR_MAX_LIGHT];
+        uint8_t nb_bme;
+        uint8_t nb_tsl;
+};
+
+#endif /* SENSOR_REGISTRY_H */
@@ -7,7 +7,7 @@
 #define ROW(x)   VERTICAL_REV(x)
 DECLARE_FONT(font);
 
-ssd1306::ssd1306(MicroBit* uB, MicroBitI2C* uBi2c, MicroBitPin* pin_reset, uint8_t addr):uBit(uB),i2c(uBi2c),reset(pin_reset), address(addr)
+ssd1306::ssd1306(MicroBit* uB, i2c_queue* uBi2c, MicroBitPin* pin_reset, uint8_t addr):uBit(uB),i2c(uBi2c),reset(pin_reset), address(addr)
 {
     buffer_set(gddram, 0x00);
     video_mode = SSD130x_DISP_NORMAL;
@@ -150,7 +150,7 @@ int ssd1306::send_command(uint8_t cmd, uint8_t* data, uint8_t len)
         }
     }
 
-    ret = i2c->write(SSD130x_ADDR, cmd_buf, 2+(len*2));
+    ret = i2c->write(SSD130x_ADDR, cmd_buf, 2+(len*2), I2C_PRIO_LOW);
     if( ret != MICROBIT_OK)
     {
         uBit->display.scroll("Command Error");
@@ -265,11 +265,10 @@ int ssd1306::update_screen()
 
 
 
-    /* Setup I2C transfer */
-    gddram[0] = SSD130x_DATA_ONLY;
-
-    /* Send data on I2C bus */
-    ret = i2c->write(SSD130x_ADDR, (char*) gddram,GDDRAM_SIZE+1);
+    /* Send data on I2C bus, each chunk starts with the data only control byte.
+     * The GDDRAM address keeps incrementing from one transfer to the next in horizontal
+     *   addressing mode. */
+    ret = i2c->write_chunked(SSD130x_ADDR, SSD130x_DATA_ONLY, (char*)gddram + 1, GDDRAM_SIZE);
     if (ret != MICROBIT_OK)
     {
         uBit->display.scroll("Full Screen Error");
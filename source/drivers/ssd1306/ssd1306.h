@@ -173,6 +173,7 @@ enum ssd130x_defs {
 
 #include <cstdint>
 #include <MicroBit.h>
+#include "i2c_queue.h"
 
 class ssd1306 {
     public:
@@ -180,7 +181,7 @@ class ssd1306 {
         /**
          *
          */
-        ssd1306(MicroBit* uB, MicroBitI2C* uBi2c, MicroBitPin* pin_reset,uint8_t addr = SSD130x_ADDR);
+        ssd1306(MicroBit* uB, i2c_queue* uBi2c, MicroBitPin* pin_reset,uint8_t addr = SSD130x_ADDR);
 
         /**
          * Power Off the screen
@@ -205,6 +206,8 @@ class ssd1306 {
         /**
          * update screen display
          * should be called after a series of display change
+         * The framebuffer is sent in chunks at low priority on the I2C queue : sensor
+         *   accesses get the bus between two chunks, only the calling fiber waits.
          */
         int update_screen();
 
@@ -230,7 +233,7 @@ class ssd1306 {
 
 
         MicroBit* uBit;
-        MicroBitI2C* i2c;
+        i2c_queue* i2c;
         MicroBitPin* reset;
         uint8_t gddram[ 1 + GDDRAM_SIZE ];
         uint8_t address;
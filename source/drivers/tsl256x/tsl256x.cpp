@@ -23,6 +23,7 @@
 
 
  #include <cstdint>
+ #include <errno.h>
 
  #include "tsl256x.h"
  
@@ -31,12 +32,13 @@
   * FIXME : Add more comments about the behavior and the resulting configuration.
   */
  #define CONF_BUF_SIZE 2
- tsl256x::tsl256x(MicroBit* uB, MicroBitI2C* uBi2c, uint8_t addr, uint8_t pkg,
+ tsl256x::tsl256x(MicroBit* uB, i2c_queue* uBi2c, uint8_t addr, uint8_t pkg,
          uint8_t p_gain, uint8_t integration)
      :
          uBit(uB), i2c(uBi2c), address(addr), package(pkg), gain(p_gain), integration_time(integration)
  {
      probe_ok = 0;
+     ready_at = 0;
      int ret = 0;
      char cmd_buf[CONF_BUF_SIZE] = { TSL256x_CMD(timing), 0, };
  
@@ -45,29 +47,46 @@
      if (probe_sensor() != 1) {
          uBit->display.scroll("TSL256X: No Device");
      }
-     uBit->sleep(1);
      ret = i2c->write(address, cmd_buf, CONF_BUF_SIZE);
      if (ret != MICROBIT_OK) {
          probe_ok = 0;
          uBit->display.scroll("TSL256x: Conf Error");
      }
+     /* Writing the timing register restarts the integration */
+     ready_at = system_timer_current_time() + integration_time_ms();
+ }
+ 
+ uint32_t tsl256x::integration_time_ms()
+ {
+     switch (integration_time) {
+         case TSL256x_INTEGRATION_13ms:
+             return TSL256x_INTEG_TIME_13ms_MS;
+         case TSL256x_INTEGRATION_100ms:
+             return TSL256x_INTEG_TIME_100ms_MS;
+         default:
+             return TSL256x_INTEG_TIME_400ms_MS;
+     }
  }
  
  
  
  /* Check the sensor presence, return 1 if found
   * This is done by writing to the control register to set the power state to ON and
-  *   reading the register to check the value, as stated in the TSL256x documentation page 14,
-  *   (Register Set definitions)
-  * FIXME : Never managed to read the required value, though the sensor is running and
-  *     provides seemingly accurate values.
+  *   reading the register back until it reports the power-on value, as stated in the TSL256x
+  *   documentation page 14 (Register Set definitions). Only the two power bits are checked :
+  *   some parts return the upper (reserved) bits set.
+  * The wait is bounded (TSL256x_POLL_MAX polls, one scheduler tick apart, so at most
+  *   TSL256x_POLL_BUDGET_MS) and usually ends on the first read. The first integration is
+  *   not waited for here, see sensor_read().
+  * The part number is then checked, so that another device answering at this address is
+  *   not taken for a light sensor.
   */
  #define PROBE_BUF_SIZE  2
  int tsl256x::probe_sensor()
  {
      int ret = 0;
      char cmd_buf[PROBE_BUF_SIZE] = { TSL256x_CMD(control), TSL256x_POWER_ON, };
-     uint8_t control_val = 72;
+     uint8_t control_val = 0;
  
      /* Did we already probe the sensor ? */
      if (probe_ok != 1) {
@@ -75,12 +94,23 @@
          if (ret != MICROBIT_OK) {
              return 0;
          }
-         uBit->sleep(500);
-         i2c->write(address, cmd_buf,1,true);
-         ret = i2c->read(address, (char*)&control_val, 1);
-         /* FIXME : check that control_val is TSL256x_POWER_ON... */
-         if (ret == MICROBIT_OK && (control_val&0x03) == TSL256x_POWER_ON) {
-             probe_ok = 1;
+         for (int i = 0; ; i++) {
+             ret = i2c->write_read(address, cmd_buf, 1, (char*)&control_val, 1);
+             if (ret != MICROBIT_OK) {
+                 return 0;
+             }
+             if ((control_val & 0x03) == TSL256x_POWER_ON) {
+                 break;
+             }
+             if (i == TSL256x_POLL_MAX) {
+                 return 0;
+             }
+             uBit->sleep(TSL256x_POLL_PERIOD_MS);
+         }
+         probe_ok = 1;
+         ret = read_id();
+         if (ret < 0 || !TSL256x_PART_VALID(ret)) {
+             probe_ok = 0;
          }
      }
      return probe_ok;
@@ -88,23 +118,23 @@
  
  
  
- /* FIXME: add comments, and make it work right ... never managed to read the ID given in
-  *   the documentation
+ /* Read the ID register (part number in the high nibble, revision in the low one)
+  * Return value:
+  *   The register value (0x00 is a valid TSL2560CS ID) when the sensor was probed.
+  *   -ENODEV when it was not, or the I2C error.
   */
- 
  #define ID_BUF_SIZE  1
  int tsl256x::read_id()
  {
      int ret = 0;
      char cmd_buf[ID_BUF_SIZE] = { TSL256x_CMD(part_id)};
-     char id = 0;
+     uint8_t id = 0;
  
      /* Did we already probe the sensor ? */
      if (probe_ok != 1) {
-         return 0;
+         return -ENODEV;
      }
-     i2c->write(address, cmd_buf, ID_BUF_SIZE, true);
-     ret = i2c->read(address, &id, 1);
+     ret = i2c->write_read(address, cmd_buf, ID_BUF_SIZE, (char*)&id, 1);
      if (ret != MICROBIT_OK) {
          probe_ok = 0;
          return ret;
@@ -118,8 +148,9 @@
   * 'lux' 'ir' and 'comb': integer addresses for conversion result, may be NULL.
   * Return value(s):
   *   Upon successfull completion, returns 0 and the luminosity read is placed in the
-  *   provided integer(s). On error, returns a negative integer equivalent to errors from
-  *   glibc.
+  *   provided integer(s). Until the first integration after power-on or configuration
+  *   is over the ADC registers hold no result : returns MICROBIT_BUSY. On error,
+  *   returns a negative integer equivalent to errors from glibc.
   */
  #define READ_BUF_SIZE  1
  int tsl256x::sensor_read(uint16_t* comb, uint16_t* ir, uint32_t* lux)
@@ -129,8 +160,10 @@
      uint8_t data[4];
      uint16_t comb_raw = 0, ir_raw = 0;
  
-     i2c->write(address, cmd_buf, READ_BUF_SIZE,true);
-     ret = i2c->read(address, (char*)data, 4);
+     if ((long)(system_timer_current_time() - ready_at) < 0) {
+         return MICROBIT_BUSY;
+     }
+     ret = i2c->write_read(address, cmd_buf, READ_BUF_SIZE, (char*)data, 4);
      if (ret != MICROBIT_OK) {
          probe_ok = 0;
          return ret;
@@ -32,8 +32,13 @@
  
  #include <cstdint>
  #include "MicroBit.h"
+ #include "i2c_queue.h"
  
- #define TSL256x_ADDR 0x52
+ /* ADDR SEL pin : GND, float, VDD */
+ #define TSL256x_ADDR_LOW    0x52
+ #define TSL256x_ADDR_FLOAT  0x72
+ #define TSL256x_ADDR_HIGH   0x92
+ #define TSL256x_ADDR        TSL256x_ADDR_LOW
  
  
  enum tsl256x_pkg_types {
@@ -67,6 +72,13 @@
  
  /* Defines for control register */
  #define TSL256x_POWER_ON          (0x03)
+ /* Control register polling after power-on, see probe_sensor()
+  * uBit->sleep() is rounded up to the DAL scheduler tick (6ms) : poll once per tick, for
+  *   at most TSL256x_POLL_BUDGET_MS.
+  */
+ #define TSL256x_POLL_PERIOD_MS    6
+ #define TSL256x_POLL_BUDGET_MS    60
+ #define TSL256x_POLL_MAX          (TSL256x_POLL_BUDGET_MS / TSL256x_POLL_PERIOD_MS)
  
  /* Defines for timing register */
  /* See page 22 of tsl256x manual for information on how to calculate lux. */
@@ -77,6 +89,10 @@
  #define TSL256x_INTEGRATION_400ms (0x02)
  #define TSL256x_INTEGRATION_100ms (0x01)
  #define TSL256x_INTEGRATION_13ms  (0x00)
+ /* Integration times, in milli-seconds (rounded up) */
+ #define TSL256x_INTEG_TIME_400ms_MS  402
+ #define TSL256x_INTEG_TIME_100ms_MS  101
+ #define TSL256x_INTEG_TIME_13ms_MS   14
  
  /* Defines for interrupt control register */
  #define TSL256x_INTR_NONE         (0x00)
@@ -88,6 +104,12 @@
  /* Defines for part ID and revision ID register */
  #define TSL256x_PART_ID(x)   (((x) & 0xF0) >> 4)
  #define TSL256x_PART_REV(x)  ((x) & 0x0F)
+ /* Part numbers */
+ #define TSL256x_PART_TSL2560CS   0x00
+ #define TSL256x_PART_TSL2561CS   0x01
+ #define TSL256x_PART_TSL2560     0x04  /* T, FN and CL packages */
+ #define TSL256x_PART_TSL2561     0x05  /* T, FN and CL packages */
+ #define TSL256x_PART_VALID(x)    ((TSL256x_PART_ID(x) & ~0x05) == 0)
  
  
  
@@ -207,21 +229,23 @@
           * Performs default configuration of the luminosity sensor.
           * FIXME : Add more comments about the behavior and the resulting configuration.
           */
-         tsl256x(MicroBit* uB, MicroBitI2C* i2c, uint8_t addr = TSL256x_ADDR, uint8_t pkg = TSL256x_PACKAGE_T,
+         tsl256x(MicroBit* uB, i2c_queue* i2c, uint8_t addr = TSL256x_ADDR, uint8_t pkg = TSL256x_PACKAGE_T,
                  uint8_t p_gain = TSL256x_LOW_GAIN, uint8_t integration = TSL256x_INTEGRATION_100ms);
  
          /* Check the sensor presence, return 1 if found
           * This is done by writing to the control register to set the power state to ON and
-          *   reading the register to check the value, as stated in the TSL256x documentation page 14,
-          *   (Register Set definitions)
-          * FIXME : Never managed to read the required value, though the sensor is running and
-          *     provides seemingly accurate values.
+          *   reading the register back until it reports the power-on value, as stated in the
+          *   TSL256x documentation page 14 (Register Set definitions). The register is polled
+          *   every TSL256x_POLL_PERIOD_MS, at most TSL256x_POLL_MAX times. The part number
+          *   read by read_id() must then be one of the TSL256x_PART_* values.
           */
          int probe_sensor();
  
  
-         /* FIXME: add comments, and make it work right ... never managed to read the ID given in
-          *   the documentation
+         /* Read the ID register (part number in the high nibble, revision in the low one)
+          * Return value:
+          *   The register value (0x00 is a valid TSL2560CS ID) when the sensor was probed.
+          *   -ENODEV when it was not, or the I2C error.
           */
          int read_id();
  
@@ -231,8 +255,9 @@
           * 'lux' 'ir' and 'comb': integer addresses for conversion result, may be NULL.
           * Return value(s):
           *   Upon successfull completion, returns 0 and the luminosity read is placed in the
-          *   provided integer(s). On error, returns a negative integer equivalent to errors from
-          *   glibc.
+          *   provided integer(s). Until the first integration after power-on or configuration
+          *   is over the ADC registers hold no result : returns MICROBIT_BUSY. On error,
+          *   returns a negative integer equivalent to errors from glibc.
           */
          int sensor_read(uint16_t* comb, uint16_t* ir, uint32_t* lux);
  
@@ -255,13 +280,17 @@
           */
          uint32_t calculate_lux(uint16_t ch0, uint16_t ch1);
  
+         /* Integration time of the configured timing, in ms */
+         uint32_t integration_time_ms();
+ 
          MicroBit* uBit;
-         MicroBitI2C* i2c;
+         i2c_queue* i2c;
          uint8_t address;
          uint8_t package;
          uint8_t gain;
          uint8_t integration_time;
          uint8_t probe_ok;
+         unsigned long ready_at;  /* system timer (ms) of the end of the first integration */
  
  };
  
@@ -2,30 +2,50 @@
  * ============================================================================
  * Fichier      : main.cpp
  * Auteur       : Mathis LAMBERT
- * Projet       : Simulation aléatoire + protocole CPE (micro:bit)
+ * Projet       : Station capteurs + protocole CPE (micro:bit)
  * Date         : Mai 2025
  * Description  :
- *   - Génère des données aléatoires (BME280 & TSL256x simulés)
+ *   - Lit les BME280 et TSL256x découverts sur le bus (sensor_registry),
+ *     un point de mesure par couple (BME n, TSL n)
  *   - Affiche les mesures sur l'OLED toutes les secondes, selon l'ordre défini
- *   - Envoie un paquet CPE contenant les mesures toutes les 2 secondes
- *   - Réception : si un paquet CTRL est reçu, on ajuste l'ordre d'affichage
- *
- *   ⚠ Pour repasser en mode "capteurs réels", dé-commentez les blocs
- *     // CAPTEURS et commentez la partie // SIMULATION.
+ *   - Envoi radio CPE (une mesure toutes les SENSOR_PERIOD_MS) :
+ *       . BATCH_SAMPLES > 0 (10 par défaut) : une trame longue toutes les
+ *         BATCH_SAMPLES mesures (~10 s), MEASURE_SERIES avec BATCH_COMPRESSED
+ *         (défaut), MEASURE_BATCH sinon ;
+ *       . plusieurs points de mesure découverts : une trame MEASURE_MULTI
+ *         par SENSOR_PERIOD_MS, tous les points au même instant ;
+ *       . trame MEASURE unitaire toutes les 2 secondes seulement avec
+ *         BATCH_SAMPLES == 0 et un seul point (AES-CCM avec AEAD_FRAMES).
+ *     Avec AUTH_FRAMES (défaut), chaque trame porte un tag CMAC.
+ *   - Réception : un paquet CTRL ajuste l'ordre d'affichage, un paquet
+ *     PROFILE change le profil de mesure des BME280
  * ============================================================================
  */
 
 #include "MicroBit.h"
-#include "bme280.h" // CAPTEURS
+#include "bme280.h"
 #include "ssd1306.h"
-#include "tsl256x.h" // CAPTEURS
+#include "tsl256x.h"
+#include "i2c_queue.h"
+#include "sensor_registry.h"
 #include "cpe.h"     // Protocole CPE v2
+#include "crypto_bench.h"
 #include <cstdlib>
+#include <cstring>
 
 #define RADIO_GROUP 42
 #define DEVICE_ID 0x02 /* identifiant unique pour ce micro:bit */
-
-static const uint8_t KEY[16] = {
+#define BATCH_SAMPLES 10 /* mesures par trame MEASURE_BATCH, 0 = trames unitaires */
+#define BATCH_COMPRESSED 1 /* 1 = trame MEASURE_SERIES (deltas / varints) */
+#define AUTH_FRAMES 1 /* 1 = tag CMAC sur toutes les trames, rejet avant déchiffrement */
+#define CRYPTO_BENCH 0 /* 1 = mesure les primitives tinycrypt et la compensation de pression au démarrage (série) */
+#define AEAD_FRAMES 0 /* 1 = trames unitaires en AES-CCM (les trames longues gardent le CMAC) */
+#define SENSOR_PERIOD_MS 1000 /* une conversion BME280 forcée par période */
+#define PRESSURE_64BIT 0 /* 1 = compensation de pression 64 bits (Q24.8 Pa), plus coûteuse */
+
+/* clé maître : chaque micro:bit chiffre avec sa clé dérivée
+ * (cpe_derive_device_key), la passerelle la retrouve par DEVICE_ID */
+static const uint8_t MASTER_KEY[16] = {
     0x00, 0x01, 0x02, 0x03,
     0x04, 0x05, 0x06, 0x07,
     0x08, 0x09, 0x0A, 0x0B,
@@ -33,22 +53,45 @@ static const uint8_t KEY[16] = {
 
 MicroBit uBit;
 MicroBitI2C i2c(I2C_SDA0, I2C_SCL0);
+/* tout le trafic I2C passe par la fibre de la file : capteurs en priorité,
+ * trame OLED découpée, la lecture capteur n'attend pas l'écran          */
+static i2c_queue i2cQueue(&i2c);
 MicroBitPin P0(MICROBIT_ID_IO_P0, MICROBIT_PIN_P0, PIN_CAPABILITY_DIGITAL_OUT);
 static ssd1306 *oled = nullptr; // construit après uBit.init()
-static bme280 *bme = nullptr;   // construit après uBit.init()
-static tsl256x *tsl = nullptr;  // construit après uBit.init()
+/* BME280 et TSL256x découverts sur le bus au démarrage ; un point de
+ * mesure par couple (BME n, TSL n)                                    */
+static sensor_registry *sensors = nullptr; // construit après uBit.init()
 
 static const char BLANK_LINE[] = "                "; // 16 espaces
 
 /* === Variables globales === */
 static uint8_t seq = 0; // Sequence radio
 static uint8_t current_ctrl = cpe_ctrl_pack(CPE_S_T, CPE_S_L, CPE_S_H, CPE_S_P);
-static cpe_measure_t lastMeasures{}; // zero-initialisé
+static cpe_measure_t lastMeasures{}; // zero-initialisé (1er point)
+static uint8_t nbPoints = 1;          // > 1 : trames MEASURE_MULTI
+static_assert(CPE_POINT_NONE == SENSOR_NONE && SENSOR_MAX_POINTS <= CPE_MULTI_MAX_POINTS,
+              "points CPE et registre capteurs désynchronisés");
+/* profil demandé par radio, appliqué par sensorLoop entre deux mesures
+ * (0xFF : aucun, le réglage du constructeur reste actif)              */
+static volatile uint8_t pendingProfile = 0xFF;
+static_assert(CPE_PROFILE_WEATHER == BME280_PROFILE_WEATHER &&
+                  CPE_PROFILE_INDOOR == BME280_PROFILE_INDOOR &&
+                  CPE_PROFILE_FAST_RESPONSE == BME280_PROFILE_FAST_RESPONSE &&
+                  CPE_PROFILE_LOW_POWER == BME280_PROFILE_LOW_POWER &&
+                  CPE_PROFILE_COUNT == BME280_NB_PROFILES,
+              "profils CPE et BME280 désynchronisés");
+#if BATCH_SAMPLES > 0
+static cpe_sample_t batch[BATCH_SAMPLES];
+static uint8_t batchCount = 0;
+#endif
 
 /* === Prototypes === */
 void onRadio(MicroBitEvent);
 static void sendMeasureFrame(const cpe_measure_t *m);
-static void generateOrReadSensors(cpe_measure_t *out);
+static void queueMeasure(const cpe_measure_t *m, uint32_t now);
+static void sendMultiFrame(const cpe_point_t *pts, uint8_t n);
+static uint8_t readSensors(cpe_point_t *out);
+static void sensorLoop();
 static void displayMeasures(const cpe_measure_t &m);
 
 /* --- utilitaire visuel ------------------------------------------- */
@@ -62,10 +105,21 @@ static inline void flash(uint8_t x, uint8_t y)
 /* === Transmission de trames CPE === */
 static void sendMeasureFrame(const cpe_measure_t *m)
 {
-    uint8_t frame[CPE_PAYLOAD_LEN];
-    cpe_build_measure_frame(m, DEVICE_ID, seq++, frame);
+    uint8_t frame[CPE_AUTH_PAYLOAD_LEN];
+    int len = CPE_PAYLOAD_LEN;
+    if (AEAD_FRAMES)
+    {
+        cpe_ccm_build_measure_frame(m, DEVICE_ID, seq++, frame);
+        len = CPE_CCM_PAYLOAD_LEN;
+    }
+    else
+    {
+        cpe_build_measure_frame(m, DEVICE_ID, seq++, frame);
+        if (AUTH_FRAMES)
+            len = cpe_auth_seal(frame, len, sizeof(frame));
+    }
     uBit.serial.send("[INFO] Envoi Paquet");
-    int ret = uBit.radio.datagram.send(frame, CPE_PAYLOAD_LEN);
+    int ret = uBit.radio.datagram.send(frame, len);
 
     if (ret != MICROBIT_OK)
     {
@@ -76,6 +130,71 @@ static void sendMeasureFrame(const cpe_measure_t *m)
     flash(0, 0);
 }
 
+/* === Plusieurs points de mesure (MEASURE_MULTI) === */
+static void sendMultiFrame(const cpe_point_t *pts, uint8_t n)
+{
+    uint8_t frame[CPE_MULTI_LEN(SENSOR_MAX_POINTS) + CPE_AUTH_TAG_LEN];
+    int len = cpe_build_multi_frame(pts, n, DEVICE_ID, seq++, frame,
+                                    CPE_MULTI_LEN(SENSOR_MAX_POINTS));
+    /* trame longue : toujours le CMAC, même en AEAD_FRAMES */
+    if ((AUTH_FRAMES || AEAD_FRAMES) && len > 0)
+        len = cpe_auth_seal(frame, len, sizeof(frame));
+    if (len < 0)
+    {
+        uBit.serial.send("[ERROR] Trame multi-points invalide\n");
+        return;
+    }
+    uBit.serial.send("[INFO] Envoi Multi");
+    if (uBit.radio.datagram.send(frame, len) != MICROBIT_OK)
+    {
+        uBit.serial.send("[ERROR] Envoi échoué\n");
+        return;
+    }
+    uBit.serial.send("[INFO] Multi envoyé\n");
+    flash(0, 0);
+}
+
+/* === Regroupement des mesures (MEASURE_BATCH) === */
+static void queueMeasure(const cpe_measure_t *m, uint32_t now)
+{
+#if BATCH_SAMPLES > 0
+    batch[batchCount].t_ms = now;
+    batch[batchCount].m = *m;
+    if (++batchCount < BATCH_SAMPLES)
+        return;
+    batchCount = 0;
+
+    /* la série compressée n'est utilisée que si elle est plus courte */
+    uint8_t frame[CPE_BATCH_LEN(BATCH_SAMPLES) + CPE_AUTH_TAG_LEN];
+    int len = -1;
+    if (BATCH_COMPRESSED)
+        len = cpe_build_series_frame(batch, BATCH_SAMPLES, DEVICE_ID, seq,
+                                     frame, CPE_BATCH_LEN(BATCH_SAMPLES));
+    if (len < 0)
+        len = cpe_build_measure_batch(batch, BATCH_SAMPLES, DEVICE_ID, seq,
+                                      frame, CPE_BATCH_LEN(BATCH_SAMPLES));
+    seq++;
+    if ((AUTH_FRAMES || AEAD_FRAMES) && len > 0)
+        len = cpe_auth_seal(frame, len, sizeof(frame));
+    if (len < 0)
+    {
+        uBit.serial.send("[ERROR] Batch invalide\n");
+        return;
+    }
+    uBit.serial.send("[INFO] Envoi Batch");
+    if (uBit.radio.datagram.send(frame, len) != MICROBIT_OK)
+    {
+        uBit.serial.send("[ERROR] Envoi échoué\n");
+        return;
+    }
+    uBit.serial.send("[INFO] Batch envoyé\n");
+    flash(0, 0);
+#else
+    (void)m;
+    (void)now;
+#endif
+}
+
 /* === Affichage selon l'ordre courant === */
 static void displayMeasures(const cpe_measure_t &m)
 {
@@ -120,86 +239,217 @@ void onRadio(MicroBitEvent)
     flash(0, 1); // signal de réception
 
     PacketBuffer p = uBit.radio.datagram.recv();
-    if (p.length() != CPE_PAYLOAD_LEN)
+    int len = p.length();
+
+    /* trames unitaires AES-CCM : tag vérifié et clair obtenu en une passe */
+    cpe_view_t v;
+    if (AEAD_FRAMES && len == CPE_CCM_PAYLOAD_LEN)
+    {
+        if (cpe_ccm_open_frame(p.getBytes(), len, &v) != 0)
+        {
+            uBit.serial.send("[WARN] Paquet non authentifié\n");
+            return;
+        }
+        len = CPE_PAYLOAD_LEN;
+    }
+    /* trafic étranger au groupe : rejeté sur le tag, sans déchiffrer */
+    else if ((AUTH_FRAMES || AEAD_FRAMES) && (len = cpe_auth_check(p.getBytes(), len)) < 0)
     {
-        uBit.serial.send("[ERROR] Paquet reçu de taille incorrecte\n");
+        uBit.serial.send("[WARN] Paquet non authentifié\n");
+        return;
+    }
+    /* déchiffrement en place dans le PacketBuffer : ni copie ni décodage
+     * sur la pile, les champs sont lus directement via la vue            */
+    else if (cpe_open_frame(p.getBytes(), len, &v) != 0)
+    {
+        uBit.serial.send("[ERROR] Paquet reçu invalide\n");
         return;
     }
 
-    cpe_frame_type_t ft;
-    uint8_t dev_id;
-    cpe_measure_t meas;
-    uint8_t ctrl;
-
-    if (cpe_parse_frame(p.getBytes(), &ft, &dev_id, &meas, &ctrl) != 0)
+    if (len > CPE_PAYLOAD_LEN)
+    {
+        uBit.serial.send("[INFO] Batch reçu\n");
         return;
+    }
 
     uBit.serial.send("[INFO] Paquet reçu\n");
     uBit.serial.send("[INFO] Type: ");
 
-    if (ft == CPE_FT_CONTROL)
+    if (cpe_view_type(&v) == CPE_FT_CONTROL)
     {
-        current_ctrl = ctrl; // met à jour l'ordre d'affichage
+        current_ctrl = cpe_view_ctrl(&v); // met à jour l'ordre d'affichage
         uBit.serial.send("[CTRL] Nouvel ordre OLED reçu\n");
     }
+    else if (cpe_view_type(&v) == CPE_FT_PROFILE)
+    {
+        if (cpe_view_profile(&v) >= CPE_PROFILE_COUNT)
+        {
+            uBit.serial.send("[WARN] Profil inconnu\n");
+            return;
+        }
+        /* pas d'I2C ici : une conversion peut être en cours */
+        pendingProfile = cpe_view_profile(&v);
+        uBit.serial.send("[CTRL] Nouveau profil de mesure reçu\n");
+    }
+}
+
+/* === Lecture des capteurs ===
+ * Remplit un cpe_point_t par point de mesure ; retourne leur nombre (>= 1).
+ * Sans capteur découvert, un point vide (SENSOR_NONE, mesures à 0).      */
+static uint8_t readSensors(cpe_point_t *out)
+{
+    struct sensor_point sp[SENSOR_MAX_POINTS];
+    /* conversions forcées lancées ensemble, la fibre dort une seule fois */
+    int n = sensors->sample(sp, SENSOR_MAX_POINTS);
+    if (n == 0)
+    {
+        memset(sp, 0, sizeof(sp[0]));
+        sp[0].env = sp[0].light = SENSOR_NONE;
+        n = 1;
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        int16_t tCenti = sp[i].env_data.temperature;
+        uint16_t hCenti = sp[i].env_data.humidity;
+        uint16_t pDeci = (sp[i].env_data.pressure_q8 + 1280) / 2560; /* Pa Q24.8 -> dixièmes de hPa, arrondi */
+        uint16_t lux = sp[i].comb;
+
+        out[i].point = cpe_point_pack(sp[i].env, sp[i].light);
+        out[i].m.temperature_centi = tCenti;
+        out[i].m.humidity_centi = hCenti;
+        out[i].m.pressure_decihPa = pDeci;
+        out[i].m.lux = lux;
+
+        char log[72];
+        snprintf(log, sizeof(log), "[TRUE] #%d T:%d.%02dC H:%d.%02d%% P:%d.%01dhPa Lux:%d\r\n",
+                 i, tCenti / 100, abs(tCenti) % 100,
+                 hCenti / 100, hCenti % 100,
+                 pDeci / 10, pDeci % 10,
+                 lux);
+        uBit.serial.send(log);
+    }
+    return (uint8_t)n;
+}
+
+/* === Fibre d'acquisition ===
+ * Les BME280 restent en veille entre deux conversions forcées ; l'attente
+ * de conversion se fait ici, jamais dans la boucle d'affichage.         */
+static void sensorLoop()
+{
+    while (true)
+    {
+        uint32_t start = system_timer_current_time();
+        uint8_t profile = pendingProfile;
+        if (profile != 0xFF)
+        {
+            pendingProfile = 0xFF;
+            /* calibration conservée, seule la configuration est réécrite */
+            if (sensors->set_profile(profile) != MICROBIT_OK)
+                uBit.serial.send("[ERROR] Profil BME280 non appliqué\n");
+            /* en mode normal, la 1re conversion n'est prête qu'après t_meas */
+            if (sensors->env(0))
+                uBit.sleep(sensors->env(0)->measurement_time_us() / 1000 + 1);
+        }
+        cpe_point_t pts[SENSOR_MAX_POINTS];
+        uint8_t n = readSensors(pts);
+        lastMeasures = pts[0].m;
+        if (n > 1)
+            sendMultiFrame(pts, n); /* tous les points au même instant */
+        else if (BATCH_SAMPLES > 0)
+            queueMeasure(&lastMeasures, start);
+
+        uint32_t elapsed = system_timer_current_time() - start;
+        uBit.sleep(elapsed < SENSOR_PERIOD_MS ? SENSOR_PERIOD_MS - elapsed : 1);
+    }
 }
 
-/* === Génération ou lecture des capteurs === */
-static void generateOrReadSensors(cpe_measure_t *out)
+/* === Mesure des primitives crypto (CRYPTO_BENCH) === */
+#if CRYPTO_BENCH
+#define CRYPTO_BENCH_ITERATIONS 50
+#define CPU_MHZ 16 /* nRF51822 : µs -> cycles */
+
+static uint64_t benchClockUs(void)
 {
-    /* -----------------------------------------------------------------
-     *  CAPTEURS : Lecture réelle (commentée pour la simulation)
-     * ----------------------------------------------------------------- */
-    uint32_t rawP;
-    int32_t rawT;
-    uint16_t rawH;
-    uint16_t tsl_comb, tsl_ir;
-    uint32_t tsl_lux;
-    int res = bme->sensor_read(&rawP, &rawT, &rawH);
-    int16_t tCenti = bme->compensate_temperature(rawT);
-    uint16_t hCenti = bme->compensate_humidity(rawH);
-    uint16_t pDeci = bme->compensate_pressure(rawP) / 10;
-    int res_tsl = tsl->sensor_read(&tsl_comb, &tsl_ir, &tsl_lux);
-    uint16_t lux = tsl_comb;
-    /* -----------------------------------------------------------------*/
-
-    /* -----------------------------------------------------------------
-     *  SIMULATION : Génération aléatoire des mesures (active)
-     * -----------------------------------------------------------------*/
-    // int16_t tCenti = 1500 + uBit.random(1500);  // 15.00 °C .. 29.99 °C
-    // uint16_t hCenti = 3000 + uBit.random(4000); // 30.00 % .. 69.99 %
-    // uint16_t pDeci = 10000 + uBit.random(500);  // 1000.0 hPa .. 1049.9 hPa
-    // uint16_t lux = uBit.random(2000);           // 0 .. 1999 lux
-
-    out->temperature_centi = tCenti;
-    out->humidity_centi = hCenti;
-    out->pressure_decihPa = pDeci;
-    out->lux = lux;
-
-    char log[64];
-    snprintf(log, sizeof(log), "[TRUE] T:%d.%02dC H:%d.%02d%% P:%d.%01dhPa Lux:%d\r\n",
-             tCenti / 100, abs(tCenti) % 100,
-             hCenti / 100, hCenti % 100,
-             pDeci / 10, pDeci % 10,
-             lux);
+    return system_timer_current_time_us();
+}
+
+static void benchReport(const crypto_bench_result_t *r, void *)
+{
+    /* µs par appel au dixième, en entiers (pas de printf flottant) */
+    uint32_t tenths = (uint32_t)(r->elapsed_us * 10 / r->iterations);
+    char log[80];
+    snprintf(log, sizeof(log), "[BENCH] %s %uo : %lu.%lu us (%lu cycles)\r\n",
+             r->name, (unsigned)r->bytes, (unsigned long)(tenths / 10),
+             (unsigned long)(tenths % 10), (unsigned long)(tenths * CPU_MHZ / 10));
     uBit.serial.send(log);
 }
 
+/* Coût des deux chemins de compensation de pression sur le Cortex-M0
+ * (le 64 bits passe par les multiplications / divisions logicielles),
+ * calibration d'exemple de la datasheet, adc variable à chaque appel  */
+#define PRESSURE_BENCH_ITERATIONS 1000
+static volatile uint32_t benchSink;
+
+static void benchPressure(void)
+{
+    static const bme280_calibration_data cal = {
+        27504, 26435, -1000,
+        36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000,
+        75, 362, 0, 313, 50, 30};
+    int32_t t_fine = bme280_compensate_t_fine(&cal, 519888);
+    crypto_bench_result_t r;
+
+    r.bytes = 0;
+    r.iterations = PRESSURE_BENCH_ITERATIONS;
+    r.name = "bme280_compensate_pressure";
+    uint64_t t0 = system_timer_current_time_us();
+    for (int32_t i = 0; i < PRESSURE_BENCH_ITERATIONS; ++i)
+        benchSink = benchSink + bme280_compensate_pressure(&cal, t_fine, 415148 + i);
+    r.elapsed_us = system_timer_current_time_us() - t0;
+    benchReport(&r, nullptr);
+
+    r.name = "bme280_compensate_pressure_q24_8";
+    t0 = system_timer_current_time_us();
+    for (int32_t i = 0; i < PRESSURE_BENCH_ITERATIONS; ++i)
+        benchSink = benchSink + bme280_compensate_pressure_q24_8(&cal, t_fine, 415148 + i);
+    r.elapsed_us = system_timer_current_time_us() - t0;
+    benchReport(&r, nullptr);
+}
+#endif
+
 /* === Programme principal === */
 int main()
 {
     uBit.init();
     uBit.serial.send("[INFO] micro:bit ready\n");
+    if (i2cQueue.start() != 0)
+        uBit.serial.send("[WARN] File I2C indisponible, accès bloquants\n");
 
     /* --- Périphériques --- */
-    oled = new ssd1306(&uBit, &i2c, &P0);
+    oled = new ssd1306(&uBit, &i2cQueue, &P0);
     uBit.serial.send("[INFO] OLED ok\n");
 
-    bme = new bme280(&uBit, &i2c);  // CAPTEURS
-    tsl = new tsl256x(&uBit, &i2c); // CAPTEURS
-    uBit.serial.send("[INFO] Capteurs BME & TSL ok\n");
-
-    cpe_init(KEY);
+    sensors = new sensor_registry(&uBit, &i2cQueue);
+    sensors->discover(BME280_OS_x16, BME280_SLEEP);   // mode forcé
+    sensors->set_pressure_compensation(PRESSURE_64BIT ? BME280_PRESSURE_64BIT : BME280_PRESSURE_32BIT);
+    nbPoints = sensors->nb_points() > 1 ? sensors->nb_points() : 1;
+    char info[48];
+    snprintf(info, sizeof(info), "[INFO] Capteurs : %d BME, %d TSL\n",
+             sensors->nb_env(), sensors->nb_light());
+    uBit.serial.send(info);
+
+#if CRYPTO_BENCH
+    /* avant la radio : pas d'interruption de réception pendant la mesure */
+    crypto_bench_run(benchClockUs, benchReport, nullptr, CRYPTO_BENCH_ITERATIONS);
+    benchPressure();
+#endif
+
+    uint8_t key[CPE_KEY_LEN];
+    cpe_derive_device_key(MASTER_KEY, DEVICE_ID, key);
+    cpe_init(key);
+    memset(key, 0, sizeof(key));
+    cpe_ks_refill(seq); /* keystream des prochaines trames */
 
     uBit.radio.setTransmitPower(7);
     int ret = uBit.radio.setGroup(RADIO_GROUP);
@@ -217,6 +467,7 @@ int main()
     }
 
     uBit.messageBus.listen(MICROBIT_ID_RADIO, MICROBIT_RADIO_EVT_DATAGRAM, onRadio);
+    create_fiber(sensorLoop);
 
     /* --- Boucle principale --- */
     uint32_t lastDisplayMs = 0;
@@ -226,16 +477,15 @@ int main()
     {
         uint32_t now = system_timer_current_time();
 
-        /* Affichage toutes les secondes */
+        /* Affichage toutes les secondes (dernière mesure de sensorLoop) */
         if (now - lastDisplayMs >= 1000)
         {
             lastDisplayMs = now;
-            generateOrReadSensors(&lastMeasures);
             displayMeasures(lastMeasures);
         }
 
-        /* Envoi radio toutes les deux secondes */
-        if (now - lastSendMs >= 2000)
+        /* Envoi radio toutes les deux secondes (sans batch, un seul point) */
+        if (BATCH_SAMPLES == 0 && nbPoints == 1 && now - lastSendMs >= 2000)
         {
             lastSendMs = now;
             sendMeasureFrame(&lastMeasures);
@@ -245,6 +495,9 @@ int main()
         if (uBit.buttonA.isPressed())
             current_ctrl = cpe_ctrl_pack(CPE_S_T, CPE_S_H, CPE_S_P, CPE_S_L);
 
+        /* Temps libre : on précalcule le keystream des trames à venir */
+        cpe_ks_refill(seq);
+
         uBit.sleep(50); // petite pause pour laisser souffler le scheduler
     }
 
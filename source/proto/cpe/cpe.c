@@ -1,113 +1,837 @@
 #include "cpe.h"
 #include <string.h>
-#include <tinycrypt/aes.h>
+#include <tinycrypt/constants.h>
 #include <tinycrypt/ctr_mode.h>
+#include <tinycrypt/utils.h>
 
-static uint8_t g_key[CPE_KEY_LEN];
+static cpe_ctx_t g_ctx; /* contexte de l'API globale (firmware) */
+
+/* le schedule n'est jamais modifié par tc_aes_encrypt, malgré son type */
+#define SCHED(c) ((TCAesKeySched_t) & (c)->sched)
+
+/* ---------- Pool de keystream ------- */
+/* L'IV CTR ne dépend que de seq : le keystream d'une trame est le premier
+ * bloc AES(iv = 0..0 | seq), dont on garde les 11 octets utiles.
+ * Le pool n'est écrit que par cpe_ctx_ks_refill : build et parse ne font
+ * que le lire, un contexte peut donc être partagé entre threads (hôte).  */
+static void ks_compute(const cpe_ctx_t *c, uint8_t seq,
+                       uint8_t ks[CPE_PLAINTEXT_LEN])
+{
+    uint8_t iv[16] = {0}, block[16];
+    iv[15] = seq;
+    tc_aes_encrypt(block, iv, SCHED(c));
+    memcpy(ks, block, CPE_PLAINTEXT_LEN);
+}
+
+static const uint8_t *ks_get(const cpe_ctx_t *c, uint8_t seq,
+                             uint8_t tmp[CPE_PLAINTEXT_LEN])
+{
+    const cpe_ks_slot_t *slot = &c->pool[seq % CPE_KS_POOL_LEN];
+    if (slot->valid && slot->seq == seq)
+        return slot->ks;
+    ks_compute(c, seq, tmp); /* miss : un seul bloc AES */
+    return tmp;
+}
 
 /* ---------- Crypto CTR -------------- */
-static void crypt(uint8_t *buf, const uint8_t iv[16])
+static void crypt(const cpe_ctx_t *c, uint8_t *buf, uint8_t seq)
+{
+    uint8_t tmp[CPE_PLAINTEXT_LEN];
+    const uint8_t *ks = ks_get(c, seq, tmp);
+    for (int i = 0; i < CPE_PLAINTEXT_LEN; ++i)
+        buf[i] ^= ks[i];
+}
+
+/* ---------- Crypto CTR multi-blocs -- */
+/* Trames longues (BATCH / SERIES).
+ * Domaine d'IV distinct des trames 12 octets : seq en iv[10], iv[11] = 1.
+ * Le compteur de blocs occupe iv[12..15] (les 32 bits incrémentés par
+ * tc_ctr_stream_crypt) : un flux de n'importe quelle longueur ne déborde
+ * jamais sur seq ni sur le domaine, pas de keystream partagé entre deux
+ * trames.                                                               */
+void cpe_ctx_stream_begin(const cpe_ctx_t *c, cpe_stream_t *st, uint8_t seq)
+{
+    uint8_t ctr[16] = {0};
+    ctr[10] = seq;
+    ctr[11] = 0x01;
+    tc_ctr_stream_init(st, ctr, SCHED(c));
+}
+
+int cpe_stream_crypt(cpe_stream_t *st, uint8_t *buf, size_t len)
 {
-    struct tc_aes_key_sched_struct ks;
-    tc_aes128_set_encrypt_key(&ks, g_key);
-    uint8_t ctr[16];
-    memcpy(ctr, iv, 16);
-    tc_ctr_mode(buf, CPE_PLAINTEXT_LEN, buf, CPE_PLAINTEXT_LEN, ctr, &ks);
+    return tc_ctr_stream_crypt(st, buf, buf, len) == TC_CRYPTO_SUCCESS ? 0 : -1;
 }
 
+static void crypt_batch(const cpe_ctx_t *c, uint8_t *buf, size_t len,
+                        uint8_t seq)
+{
+    cpe_stream_t st;
+    cpe_ctx_stream_begin(c, &st, seq);
+    cpe_stream_crypt(&st, buf, len);
+}
+
+/* ---------- Mesure ----------------- */
+/* code généré depuis CPE_MEASURE_FIELDS (cpe.h) */
+#define put_measure(m, p) cpe_measure_pack((m), (p))
+#define get_measure(p, m) cpe_measure_unpack((p), (m))
+
 /* ---------- Pack MEASURE ------------ */
 static void pack_measure(const cpe_measure_t *m, uint8_t dev,
                          uint8_t p[CPE_PLAINTEXT_LEN])
 {
     p[0] = CPE_FT_MEASURE;
     p[1] = dev;
-
-    p[2] = ((uint16_t)m->temperature_centi) >> 8;
-    p[3] = ((uint16_t)m->temperature_centi) & 0xFF;
-    p[4] = (m->humidity_centi) >> 8;
-    p[5] = (m->humidity_centi) & 0xFF;
-    p[6] = (m->pressure_decihPa) >> 8;
-    p[7] = (m->pressure_decihPa) & 0xFF;
-    p[8] = ((uint16_t)m->lux) >> 8;
-    p[9] = ((uint16_t)m->lux) & 0xFF;
-    p[10] = 0; /* pad */
+    put_measure(m, p + 2);
+    p[2 + CPE_MEASURE_LEN] = 0; /* pad */
 }
 
-/* ---------- Pack CONTROL ------------ */
-static void pack_control(uint8_t ctrl, uint8_t dev,
+/* ---------- Pack CONTROL / PROFILE -- */
+static void pack_control(uint8_t type, uint8_t ctrl, uint8_t dev,
                          uint8_t p[CPE_PLAINTEXT_LEN])
 {
     memset(p, 0, CPE_PLAINTEXT_LEN);
-    p[0] = CPE_FT_CONTROL;
+    p[0] = type;
     p[1] = dev;
-    p[2] = ctrl; /* ordre OLED */
+    p[2] = ctrl; /* ordre OLED ou profil */
+}
+
+/* trames courtes dont le clair a une forme connue */
+static int short_frame_type(uint8_t t)
+{
+    return t == CPE_FT_MEASURE || t == CPE_FT_CONTROL || t == CPE_FT_PROFILE;
 }
 
 /* ---------- Bâtisseur commun -------- */
-static void build_common(const uint8_t plain[11], uint8_t seq,
-                         uint8_t out[CPE_PAYLOAD_LEN])
+static void build_common(const cpe_ctx_t *c,
+                         const uint8_t plain[CPE_PLAINTEXT_LEN],
+                         uint8_t seq, uint8_t out[CPE_PAYLOAD_LEN])
 {
-    uint8_t iv[16] = {0};
-    iv[15] = seq;
-    uint8_t buf[11];
-    memcpy(buf, plain, 11);
-    crypt(buf, iv);
+    uint8_t buf[CPE_PLAINTEXT_LEN];
+    memcpy(buf, plain, CPE_PLAINTEXT_LEN);
+    crypt(c, buf, seq);
     out[0] = seq;
-    memcpy(out + 1, buf, 11);
+    memcpy(out + 1, buf, CPE_PLAINTEXT_LEN);
+}
+
+/* ---------- Dérivation de clé ------- */
+void cpe_derive_device_key_sched(const struct tc_aes_key_sched_struct *master,
+                                 uint8_t device_id, uint8_t key_out[CPE_KEY_LEN])
+{
+    /* un bloc AES suffit pour 128 bits ; libellé distinct de "CPE-MAC" */
+    uint8_t label[CPE_KEY_LEN] = {'C', 'P', 'E', '-', 'D', 'E', 'V'};
+    label[CPE_KEY_LEN - 1] = device_id;
+    tc_aes_encrypt(key_out, label, (TCAesKeySched_t)master);
+}
+
+void cpe_derive_device_key(const uint8_t master_key[CPE_KEY_LEN], uint8_t device_id,
+                           uint8_t key_out[CPE_KEY_LEN])
+{
+    struct tc_aes_key_sched_struct master;
+    tc_aes128_set_encrypt_key(&master, master_key);
+    cpe_derive_device_key_sched(&master, device_id, key_out);
+    memset(&master, 0, sizeof(master));
 }
 
 /* ---------- API build --------------- */
-void cpe_init(const uint8_t key[CPE_KEY_LEN])
+void cpe_ctx_init(cpe_ctx_t *c, const uint8_t key[CPE_KEY_LEN])
 {
-    memcpy(g_key, key, CPE_KEY_LEN);
+    memset(c, 0, sizeof(*c));
+    tc_aes128_set_encrypt_key(&c->sched, key);
+
+    /* clé MAC = AES_K("CPE-MAC") : octet 0 non nul, donc hors des
+     * domaines d'IV CTR (qui commencent tous par 0)                */
+    uint8_t mac_key[CPE_KEY_LEN] = {'C', 'P', 'E', '-', 'M', 'A', 'C'};
+    tc_aes_encrypt(mac_key, mac_key, &c->sched);
+    tc_cmac_setup(&c->cmac, mac_key, &c->mac_sched);
+    memset(mac_key, 0, sizeof(mac_key));
 }
 
-void cpe_build_measure_frame(const cpe_measure_t *m,
-                             uint8_t dev, uint8_t seq, uint8_t outf[12])
+int cpe_ctx_ks_refill(cpe_ctx_t *c, uint8_t next_seq)
+{
+    int computed = 0;
+    for (int i = 0; i < CPE_KS_POOL_LEN; ++i)
+    {
+        uint8_t seq = (uint8_t)(next_seq + i);
+        cpe_ks_slot_t *slot = &c->pool[seq % CPE_KS_POOL_LEN];
+        if (slot->valid && slot->seq == seq)
+            continue;
+        ks_compute(c, seq, slot->ks);
+        slot->seq = seq;
+        slot->valid = 1;
+        ++computed;
+    }
+    return computed;
+}
+
+void cpe_ctx_build_measure_frame(const cpe_ctx_t *c, const cpe_measure_t *m,
+                                 uint8_t dev, uint8_t seq, uint8_t outf[CPE_PAYLOAD_LEN])
 {
-    uint8_t p[11];
+    uint8_t p[CPE_PLAINTEXT_LEN];
     pack_measure(m, dev, p);
-    build_common(p, seq, outf);
+    build_common(c, p, seq, outf);
 }
-void cpe_build_control_frame(uint8_t ctrl,
-                             uint8_t dev, uint8_t seq, uint8_t outf[12])
+void cpe_ctx_build_control_frame(const cpe_ctx_t *c, uint8_t ctrl,
+                                 uint8_t dev, uint8_t seq, uint8_t outf[CPE_PAYLOAD_LEN])
+{
+    uint8_t p[CPE_PLAINTEXT_LEN];
+    pack_control(CPE_FT_CONTROL, ctrl, dev, p);
+    build_common(c, p, seq, outf);
+}
+void cpe_ctx_build_profile_frame(const cpe_ctx_t *c, uint8_t profile,
+                                 uint8_t dev, uint8_t seq, uint8_t outf[CPE_PAYLOAD_LEN])
+{
+    uint8_t p[CPE_PLAINTEXT_LEN];
+    pack_control(CPE_FT_PROFILE, profile, dev, p);
+    build_common(c, p, seq, outf);
+}
+
+/* ---------- Ouverture en place ------ */
+int cpe_ctx_open_frame(const cpe_ctx_t *c, uint8_t *f, size_t len,
+                       cpe_view_t *v)
+{
+    if (!f || !v || len < CPE_PAYLOAD_LEN || len > CPE_BATCH_MAX_LEN)
+        return -1;
+
+    uint8_t *p = f + 1;
+    if (len == CPE_PAYLOAD_LEN)
+    {
+        crypt(c, p, f[0]);
+        if (!short_frame_type(p[0]))
+            return -1;
+    }
+    else
+    {
+        crypt_batch(c, p, len - 1, f[0]);
+        if (p[0] == CPE_FT_MEASURE_BATCH)
+        {
+            if (p[2] == 0 || len != (size_t)CPE_BATCH_LEN(p[2]))
+                return -1;
+        }
+        else if (p[0] == CPE_FT_MEASURE_MULTI)
+        {
+            if (p[2] == 0 || p[2] > CPE_MULTI_MAX_POINTS ||
+                len != (size_t)CPE_MULTI_LEN(p[2]))
+                return -1;
+        }
+        else if (p[0] != CPE_FT_MEASURE_SERIES ||
+                 len < 1 + 2 + CPE_SERIES_HDR_LEN)
+            return -1;
+    }
+    v->p = p;
+    v->len = len - 1;
+    return 0;
+}
+
+int cpe_view_samples(const cpe_view_t *v, cpe_sample_t *s, uint8_t max)
 {
-    uint8_t p[11];
-    pack_control(ctrl, dev, p);
-    build_common(p, seq, outf);
+    if (!v || !s)
+        return -1;
+    if (cpe_view_type(v) == CPE_FT_MEASURE_SERIES)
+        return cpe_series_decode(v->p + 2, v->len - 2, s, max);
+    if (cpe_view_type(v) != CPE_FT_MEASURE_BATCH)
+        return -1;
+
+    uint8_t n = cpe_view_sample_count(v);
+    if (n > max)
+        return -1;
+    const uint8_t *p = v->p;
+    uint32_t t = ((uint32_t)p[3] << 24) | ((uint32_t)p[4] << 16) |
+                 ((uint32_t)p[5] << 8) | p[6];
+    p += CPE_BATCH_HDR_LEN;
+    for (uint8_t i = 0; i < n; ++i, p += CPE_BATCH_SAMPLE_LEN)
+    {
+        t += (uint32_t)((p[0] << 8) | p[1]);
+        s[i].t_ms = t;
+        get_measure(p + 2, &s[i].m);
+    }
+    return n;
 }
 
 /* ---------- Parse ------------------- */
-int cpe_parse_frame(const uint8_t f[12], cpe_frame_type_t *t,
-                    uint8_t *dev, cpe_measure_t *m, uint8_t *c)
+/* Variantes sur trame constante : copie locale puis ouverture en place */
+int cpe_ctx_parse_frame(const cpe_ctx_t *ctx, const uint8_t f[CPE_PAYLOAD_LEN],
+                        cpe_frame_type_t *t, uint8_t *dev,
+                        cpe_measure_t *m, uint8_t *c)
 {
     if (!f || !t || !dev)
         return -1;
-    uint8_t seq = f[0], iv[16] = {0};
-    iv[15] = seq;
-    uint8_t buf[11];
-    memcpy(buf, f + 1, 11);
-    crypt(buf, iv);
+    uint8_t buf[CPE_PAYLOAD_LEN];
+    cpe_view_t v;
+    memcpy(buf, f, CPE_PAYLOAD_LEN);
+    if (cpe_ctx_open_frame(ctx, buf, CPE_PAYLOAD_LEN, &v) != 0)
+        return -1;
 
-    *t = (cpe_frame_type_t)buf[0];
-    *dev = buf[1];
+    *t = cpe_view_type(&v);
+    *dev = cpe_view_device_id(&v);
 
     if (*t == CPE_FT_MEASURE)
     {
         if (!m)
             return -1;
-        m->temperature_centi = (int16_t)((buf[2] << 8) | buf[3]);
-        m->humidity_centi = (uint16_t)((buf[4] << 8) | buf[5]);
-        m->pressure_decihPa = (uint16_t)((buf[6] << 8) | buf[7]);
-        m->lux = (int16_t)((buf[8] << 8) | buf[9]);
+        get_measure(v.p + 2, m);
     }
-    else if (*t == CPE_FT_CONTROL)
+    else
     {
         if (!c)
             return -1;
-        *c = buf[2];
+        *c = cpe_view_ctrl(&v); /* même octet pour CPE_FT_PROFILE */
     }
-    else
+    return 0;
+}
+
+/* ---------- Batch ------------------- */
+int cpe_ctx_build_measure_batch(const cpe_ctx_t *c, const cpe_sample_t *s,
+                                uint8_t n, uint8_t dev, uint8_t seq,
+                                uint8_t *outf, size_t out_len)
+{
+    if (!s || !outf || n == 0 || n > CPE_BATCH_MAX_SAMPLES ||
+        out_len < (size_t)CPE_BATCH_LEN(n))
+        return -1;
+
+    uint8_t *p = outf + 1;
+    uint32_t t0 = s[0].t_ms;
+    p[0] = CPE_FT_MEASURE_BATCH;
+    p[1] = dev;
+    p[2] = n;
+    p[3] = t0 >> 24;
+    p[4] = (t0 >> 16) & 0xFF;
+    p[5] = (t0 >> 8) & 0xFF;
+    p[6] = t0 & 0xFF;
+    p += CPE_BATCH_HDR_LEN;
+
+    uint32_t prev = t0;
+    for (uint8_t i = 0; i < n; ++i, p += CPE_BATCH_SAMPLE_LEN)
+    {
+        uint32_t dt = s[i].t_ms - prev;
+        if (s[i].t_ms < prev || dt > 0xFFFF)
+            return -1;
+        prev = s[i].t_ms;
+        p[0] = dt >> 8;
+        p[1] = dt & 0xFF;
+        put_measure(&s[i].m, p + 2);
+    }
+
+    int len = CPE_BATCH_LEN(n);
+    crypt_batch(c, outf + 1, len - 1, seq);
+    outf[0] = seq;
+    return len;
+}
+
+int cpe_ctx_parse_measure_batch(const cpe_ctx_t *c, const uint8_t *f,
+                                size_t len, uint8_t *dev, cpe_sample_t *s,
+                                uint8_t max)
+{
+    uint8_t buf[CPE_BATCH_MAX_LEN];
+    cpe_view_t v;
+
+    if (!f || !dev || !s || len <= CPE_PAYLOAD_LEN || len > CPE_BATCH_MAX_LEN)
+        return -1;
+    memcpy(buf, f, len);
+    if (cpe_ctx_open_frame(c, buf, len, &v) != 0)
+        return -1;
+
+    *dev = cpe_view_device_id(&v);
+    return cpe_view_samples(&v, s, max);
+}
+
+/* ---------- Multi-points ------------ */
+int cpe_ctx_build_multi_frame(const cpe_ctx_t *c, const cpe_point_t *pts,
+                              uint8_t n, uint8_t dev, uint8_t seq,
+                              uint8_t *outf, size_t out_len)
+{
+    if (!pts || !outf || n == 0 || n > CPE_MULTI_MAX_POINTS ||
+        out_len < (size_t)CPE_MULTI_LEN(n))
+        return -1;
+
+    uint8_t *p = outf + 1;
+    p[0] = CPE_FT_MEASURE_MULTI;
+    p[1] = dev;
+    p[2] = n;
+    p += CPE_MULTI_HDR_LEN;
+    for (uint8_t i = 0; i < n; ++i, p += CPE_MULTI_POINT_LEN)
+    {
+        p[0] = pts[i].point;
+        put_measure(&pts[i].m, p + 1);
+    }
+
+    int len = CPE_MULTI_LEN(n);
+    crypt_batch(c, outf + 1, len - 1, seq);
+    outf[0] = seq;
+    return len;
+}
+
+int cpe_view_points(const cpe_view_t *v, cpe_point_t *pts, uint8_t max)
+{
+    if (!v || !pts || cpe_view_type(v) != CPE_FT_MEASURE_MULTI)
+        return -1;
+
+    uint8_t n = cpe_view_sample_count(v);
+    if (n > max)
+        return -1;
+    const uint8_t *p = v->p + CPE_MULTI_HDR_LEN;
+    for (uint8_t i = 0; i < n; ++i, p += CPE_MULTI_POINT_LEN)
+    {
+        pts[i].point = p[0];
+        get_measure(p + 1, &pts[i].m);
+    }
+    return n;
+}
+
+int cpe_ctx_parse_multi_frame(const cpe_ctx_t *c, const uint8_t *f, size_t len,
+                              uint8_t *dev, cpe_point_t *pts, uint8_t max)
+{
+    uint8_t buf[CPE_BATCH_MAX_LEN];
+    cpe_view_t v;
+
+    if (!f || !dev || !pts || len <= CPE_PAYLOAD_LEN || len > CPE_BATCH_MAX_LEN)
+        return -1;
+    memcpy(buf, f, len);
+    if (cpe_ctx_open_frame(c, buf, len, &v) != 0)
+        return -1;
+
+    *dev = cpe_view_device_id(&v);
+    return cpe_view_points(&v, pts, max);
+}
+
+/* ---------- Série compressée -------- */
+static inline uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static size_t put_varint(uint8_t *p, uint32_t v)
+{
+    size_t i = 0;
+    while (v >= 0x80)
+    {
+        p[i++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[i++] = (uint8_t)v;
+    return i;
+}
+
+/* retourne le nb d'octets lus, 0 si la varint déborde de [p, end[ */
+static size_t get_varint(const uint8_t *p, const uint8_t *end, uint32_t *v)
+{
+    uint32_t r = 0;
+    for (size_t i = 0; i < 5 && p + i < end; ++i)
+    {
+        r |= (uint32_t)(p[i] & 0x7F) << (7 * i);
+        if (!(p[i] & 0x80))
+        {
+            *v = r;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/* par échantillon : dod(t) puis un delta par champ du schéma */
+#define SERIES_VALUES (1 + CPE_MEASURE_NFIELDS)
+#define SERIES_SAMPLE_MAX (1 + 5 * SERIES_VALUES)
+
+/* le masque de présence tient sur un octet */
+typedef char series_mask_fits[SERIES_VALUES <= 8 ? 1 : -1];
+
+/* champs bruts (non signés, largeur du fil) pour le calcul des deltas */
+#define X_TO_RAW(name, width, type, scale) \
+    f[CPE_MIDX_##name] = (uint32_t)m->name;
+#define X_FROM_RAW(name, width, type, scale) \
+    m->name = (type)f[CPE_MIDX_##name];
+#define X_WIDTH(name, width, type, scale) width,
+
+static const uint8_t field_width[CPE_MEASURE_NFIELDS] = {
+    CPE_MEASURE_FIELDS(X_WIDTH)};
+
+static void measure_fields(const cpe_measure_t *m,
+                           uint32_t f[CPE_MEASURE_NFIELDS])
+{
+    CPE_MEASURE_FIELDS(X_TO_RAW)
+}
+
+static void fields_measure(const uint32_t f[CPE_MEASURE_NFIELDS],
+                           cpe_measure_t *m)
+{
+    CPE_MEASURE_FIELDS(X_FROM_RAW)
+}
+
+/* delta modulo 2^(8 * width), ramené en signé */
+static inline int32_t field_delta(uint32_t cur, uint32_t prev, uint8_t width)
+{
+    unsigned shift = 32 - 8 * width;
+    return (int32_t)((cur - prev) << shift) >> shift;
+}
+
+int cpe_series_encode(const cpe_sample_t *s, uint8_t n, uint8_t *out,
+                      size_t out_len)
+{
+    if (!s || !out || n == 0 || n > CPE_SERIES_MAX_SAMPLES ||
+        out_len < CPE_SERIES_HDR_LEN)
         return -1;
+
+    uint8_t *p = out;
+    uint32_t t0 = s[0].t_ms;
+    p[0] = n;
+    p[1] = t0 >> 24;
+    p[2] = (t0 >> 16) & 0xFF;
+    p[3] = (t0 >> 8) & 0xFF;
+    p[4] = t0 & 0xFF;
+    put_measure(&s[0].m, p + 5);
+    p += CPE_SERIES_HDR_LEN;
+
+    int32_t prev_dt = 0;
+    uint32_t prev[CPE_MEASURE_NFIELDS], cur[CPE_MEASURE_NFIELDS];
+    measure_fields(&s[0].m, prev);
+
+    for (uint8_t i = 1; i < n; ++i)
+    {
+        uint8_t tmp[SERIES_SAMPLE_MAX];
+        uint32_t zz[SERIES_VALUES];
+        int32_t dt = (int32_t)(s[i].t_ms - s[i - 1].t_ms);
+        size_t k = 1;
+
+        measure_fields(&s[i].m, cur);
+        zz[0] = zigzag(dt - prev_dt);
+        for (int j = 0; j < CPE_MEASURE_NFIELDS; ++j)
+            zz[1 + j] = zigzag(field_delta(cur[j], prev[j], field_width[j]));
+
+        tmp[0] = 0;
+        for (int j = 0; j < SERIES_VALUES; ++j)
+        {
+            if (zz[j] == 0)
+                continue;
+            tmp[0] |= 1U << j;
+            k += put_varint(tmp + k, zz[j]);
+        }
+        if ((size_t)(p - out) + k > out_len)
+            return -1;
+        memcpy(p, tmp, k);
+        p += k;
+
+        prev_dt = dt;
+        memcpy(prev, cur, sizeof(prev));
+    }
+    return (int)(p - out);
+}
+
+int cpe_series_decode(const uint8_t *in, size_t len, cpe_sample_t *s,
+                      uint8_t max)
+{
+    if (!in || !s || len < CPE_SERIES_HDR_LEN)
+        return -1;
+
+    const uint8_t *end = in + len;
+    uint8_t n = in[0];
+    if (n == 0 || n > max)
+        return -1;
+
+    s[0].t_ms = ((uint32_t)in[1] << 24) | ((uint32_t)in[2] << 16) |
+                ((uint32_t)in[3] << 8) | in[4];
+    get_measure(in + 5, &s[0].m);
+    const uint8_t *p = in + CPE_SERIES_HDR_LEN;
+
+    int32_t dt = 0;
+    uint32_t f[CPE_MEASURE_NFIELDS];
+    measure_fields(&s[0].m, f);
+
+    for (uint8_t i = 1; i < n; ++i)
+    {
+        int32_t d[SERIES_VALUES] = {0};
+        if (p >= end)
+            return -1;
+        uint8_t mask = *p++;
+        for (int j = 0; j < SERIES_VALUES; ++j)
+        {
+            uint32_t v;
+            size_t k;
+            if (!(mask & (1U << j)))
+                continue;
+            if ((k = get_varint(p, end, &v)) == 0)
+                return -1;
+            p += k;
+            d[j] = unzigzag(v);
+        }
+        dt += d[0];
+        s[i].t_ms = s[i - 1].t_ms + (uint32_t)dt;
+        for (int j = 0; j < CPE_MEASURE_NFIELDS; ++j)
+            f[j] += (uint32_t)d[1 + j];
+        fields_measure(f, &s[i].m);
+    }
+    return p == end ? n : -1;
+}
+
+int cpe_ctx_build_series_frame(const cpe_ctx_t *c, const cpe_sample_t *s,
+                               uint8_t n, uint8_t dev, uint8_t seq,
+                               uint8_t *outf, size_t out_len)
+{
+    if (!outf || out_len < 3)
+        return -1;
+    if (out_len > CPE_BATCH_MAX_LEN)
+        out_len = CPE_BATCH_MAX_LEN;
+
+    int body = cpe_series_encode(s, n, outf + 3, out_len - 3);
+    if (body < 0)
+        return -1;
+    outf[1] = CPE_FT_MEASURE_SERIES;
+    outf[2] = dev;
+
+    int len = 3 + body;
+    crypt_batch(c, outf + 1, len - 1, seq);
+    outf[0] = seq;
+    return len;
+}
+
+/* ---------- MAC incrémental --------- */
+void cpe_ctx_mac_begin(const cpe_ctx_t *c, cpe_mac_t *mac)
+{
+    /* copie : tc_cmac_final efface l'état, sous-clés comprises ; celui du
+     * contexte reste à l'état initial pour toute sa durée de vie         */
+    mac->st = c->cmac;
+}
+
+int cpe_mac_update(cpe_mac_t *mac, const uint8_t *data, size_t len)
+{
+    if (!mac)
+        return -1;
+    return tc_cmac_update(&mac->st, data, len) == TC_CRYPTO_SUCCESS ? 0 : -1;
+}
+
+void cpe_mac_final(cpe_mac_t *mac, uint8_t *tag, size_t tag_len)
+{
+    uint8_t full[16];
+    tc_cmac_final(full, &mac->st);
+    memcpy(tag, full, tag_len < sizeof(full) ? tag_len : sizeof(full));
+    _set(full, 0, sizeof(full));
+}
+
+int cpe_mac_verify(cpe_mac_t *mac, const uint8_t *tag, size_t tag_len)
+{
+    uint8_t full[16];
+    if (tag_len == 0 || tag_len > sizeof(full))
+        return -1;
+    cpe_mac_final(mac, full, sizeof(full));
+    return _compare(full, tag, tag_len) == 0 ? 0 : -1;
+}
+
+/* ---------- Authentification -------- */
+static void auth_tag(const cpe_ctx_t *c, const uint8_t *f, size_t len,
+                     uint8_t tag[16])
+{
+    cpe_mac_t mac;
+    cpe_ctx_mac_begin(c, &mac);
+    cpe_mac_update(&mac, f, len);
+    cpe_mac_final(&mac, tag, 16);
+}
+
+int cpe_ctx_auth_seal(const cpe_ctx_t *c, uint8_t *f, size_t len,
+                      size_t out_len)
+{
+    uint8_t tag[16];
+    if (!f || len == 0 || out_len < len + CPE_AUTH_TAG_LEN)
+        return -1;
+    auth_tag(c, f, len, tag);
+    memcpy(f + len, tag, CPE_AUTH_TAG_LEN);
+    return (int)(len + CPE_AUTH_TAG_LEN);
+}
+
+int cpe_ctx_auth_check(const cpe_ctx_t *c, const uint8_t *f, size_t len)
+{
+    uint8_t tag[16];
+    if (!f || len <= CPE_AUTH_TAG_LEN)
+        return -1;
+    len -= CPE_AUTH_TAG_LEN;
+    auth_tag(c, f, len, tag);
+    if (_compare(tag, f + len, CPE_AUTH_TAG_LEN) != 0)
+        return -1;
+    return (int)len;
+}
+
+/* ---------- AEAD (AES-CCM) ---------- */
+/* Blocs CCM : octet de flags 0x01 (compteur) ou 0x09 (B0, tag 4 octets),
+ * donc hors des IV CTR (octet 0 nul) et du bloc de dérivation MAC ('C') :
+ * la clé de trame et son schedule servent directement.                 */
+static void ccm_setup(const cpe_ctx_t *c, struct tc_ccm_mode_struct *ccm,
+                      uint8_t nonce[13], uint8_t seq)
+{
+    memset(nonce, 0, 13);
+    nonce[12] = seq;
+    tc_ccm_config(ccm, SCHED(c), nonce, 13, CPE_CCM_TAG_LEN);
+}
+
+static void build_ccm(const cpe_ctx_t *c, const uint8_t plain[CPE_PLAINTEXT_LEN],
+                      uint8_t seq, uint8_t out[CPE_CCM_PAYLOAD_LEN])
+{
+    struct tc_ccm_mode_struct ccm;
+    uint8_t nonce[13];
+
+    ccm_setup(c, &ccm, nonce, seq);
+    tc_ccm_generation_encryption(out + 1, CPE_CCM_PAYLOAD_LEN - 1, NULL, 0,
+                                 plain, CPE_PLAINTEXT_LEN, &ccm);
+    out[0] = seq;
+}
+
+void cpe_ctx_ccm_build_measure_frame(const cpe_ctx_t *c, const cpe_measure_t *m,
+                                     uint8_t dev, uint8_t seq,
+                                     uint8_t outf[CPE_CCM_PAYLOAD_LEN])
+{
+    uint8_t p[CPE_PLAINTEXT_LEN];
+    pack_measure(m, dev, p);
+    build_ccm(c, p, seq, outf);
+}
+
+void cpe_ctx_ccm_build_control_frame(const cpe_ctx_t *c, uint8_t ctrl,
+                                     uint8_t dev, uint8_t seq,
+                                     uint8_t outf[CPE_CCM_PAYLOAD_LEN])
+{
+    uint8_t p[CPE_PLAINTEXT_LEN];
+    pack_control(CPE_FT_CONTROL, ctrl, dev, p);
+    build_ccm(c, p, seq, outf);
+}
+
+void cpe_ctx_ccm_build_profile_frame(const cpe_ctx_t *c, uint8_t profile,
+                                     uint8_t dev, uint8_t seq,
+                                     uint8_t outf[CPE_CCM_PAYLOAD_LEN])
+{
+    uint8_t p[CPE_PLAINTEXT_LEN];
+    pack_control(CPE_FT_PROFILE, profile, dev, p);
+    build_ccm(c, p, seq, outf);
+}
+
+int cpe_ctx_ccm_open_frame(const cpe_ctx_t *c, uint8_t *f, size_t len,
+                           cpe_view_t *v)
+{
+    struct tc_ccm_mode_struct ccm;
+    uint8_t nonce[13];
+
+    if (!f || !v || len != CPE_CCM_PAYLOAD_LEN)
+        return -1;
+    ccm_setup(c, &ccm, nonce, f[0]);
+    /* déchiffrement en place : le tag, en fin de trame, n'est pas écrasé */
+    if (tc_ccm_decryption_verification(f + 1, CPE_PLAINTEXT_LEN, NULL, 0, f + 1,
+                                       CPE_CCM_PAYLOAD_LEN - 1, &ccm) != TC_CRYPTO_SUCCESS)
+        return -1;
+    if (!short_frame_type(f[1]))
+        return -1;
+    v->p = f + 1;
+    v->len = CPE_PLAINTEXT_LEN;
     return 0;
 }
+
+/* ---------- API globale (firmware) -- */
+void cpe_init(const uint8_t key[CPE_KEY_LEN])
+{
+    cpe_ctx_init(&g_ctx, key);
+}
+
+int cpe_ks_refill(uint8_t next_seq)
+{
+    return cpe_ctx_ks_refill(&g_ctx, next_seq);
+}
+
+void cpe_build_measure_frame(const cpe_measure_t *m,
+                             uint8_t dev, uint8_t seq, uint8_t outf[CPE_PAYLOAD_LEN])
+{
+    cpe_ctx_build_measure_frame(&g_ctx, m, dev, seq, outf);
+}
+
+void cpe_build_control_frame(uint8_t ctrl,
+                             uint8_t dev, uint8_t seq, uint8_t outf[CPE_PAYLOAD_LEN])
+{
+    cpe_ctx_build_control_frame(&g_ctx, ctrl, dev, seq, outf);
+}
+
+void cpe_build_profile_frame(uint8_t profile,
+                             uint8_t dev, uint8_t seq, uint8_t outf[CPE_PAYLOAD_LEN])
+{
+    cpe_ctx_build_profile_frame(&g_ctx, profile, dev, seq, outf);
+}
+
+int cpe_parse_frame(const uint8_t f[CPE_PAYLOAD_LEN], cpe_frame_type_t *t,
+                    uint8_t *dev, cpe_measure_t *m, uint8_t *c)
+{
+    return cpe_ctx_parse_frame(&g_ctx, f, t, dev, m, c);
+}
+
+int cpe_build_measure_batch(const cpe_sample_t *s, uint8_t n, uint8_t dev,
+                            uint8_t seq, uint8_t *outf, size_t out_len)
+{
+    return cpe_ctx_build_measure_batch(&g_ctx, s, n, dev, seq, outf, out_len);
+}
+
+int cpe_build_series_frame(const cpe_sample_t *s, uint8_t n, uint8_t dev,
+                           uint8_t seq, uint8_t *outf, size_t out_len)
+{
+    return cpe_ctx_build_series_frame(&g_ctx, s, n, dev, seq, outf, out_len);
+}
+
+int cpe_parse_measure_batch(const uint8_t *f, size_t len, uint8_t *dev,
+                            cpe_sample_t *s, uint8_t max)
+{
+    return cpe_ctx_parse_measure_batch(&g_ctx, f, len, dev, s, max);
+}
+
+int cpe_build_multi_frame(const cpe_point_t *pts, uint8_t n, uint8_t dev,
+                          uint8_t seq, uint8_t *outf, size_t out_len)
+{
+    return cpe_ctx_build_multi_frame(&g_ctx, pts, n, dev, seq, outf, out_len);
+}
+
+int cpe_parse_multi_frame(const uint8_t *f, size_t len, uint8_t *dev,
+                          cpe_point_t *pts, uint8_t max)
+{
+    return cpe_ctx_parse_multi_frame(&g_ctx, f, len, dev, pts, max);
+}
+
+void cpe_stream_begin(cpe_stream_t *st, uint8_t seq)
+{
+    cpe_ctx_stream_begin(&g_ctx, st, seq);
+}
+
+void cpe_mac_begin(cpe_mac_t *mac)
+{
+    cpe_ctx_mac_begin(&g_ctx, mac);
+}
+
+int cpe_open_frame(uint8_t *f, size_t len, cpe_view_t *v)
+{
+    return cpe_ctx_open_frame(&g_ctx, f, len, v);
+}
+
+void cpe_ccm_build_measure_frame(const cpe_measure_t *m, uint8_t dev,
+                                 uint8_t seq, uint8_t outf[CPE_CCM_PAYLOAD_LEN])
+{
+    cpe_ctx_ccm_build_measure_frame(&g_ctx, m, dev, seq, outf);
+}
+
+void cpe_ccm_build_control_frame(uint8_t ctrl, uint8_t dev, uint8_t seq,
+                                 uint8_t outf[CPE_CCM_PAYLOAD_LEN])
+{
+    cpe_ctx_ccm_build_control_frame(&g_ctx, ctrl, dev, seq, outf);
+}
+
+void cpe_ccm_build_profile_frame(uint8_t profile, uint8_t dev, uint8_t seq,
+                                 uint8_t outf[CPE_CCM_PAYLOAD_LEN])
+{
+    cpe_ctx_ccm_build_profile_frame(&g_ctx, profile, dev, seq, outf);
+}
+
+int cpe_ccm_open_frame(uint8_t *f, size_t len, cpe_view_t *v)
+{
+    return cpe_ctx_ccm_open_frame(&g_ctx, f, len, v);
+}
+
+int cpe_auth_seal(uint8_t *f, size_t len, size_t out_len)
+{
+    return cpe_ctx_auth_seal(&g_ctx, f, len, out_len);
+}
+
+int cpe_auth_check(const uint8_t *f, size_t len)
+{
+    return cpe_ctx_auth_check(&g_ctx, f, len);
+}
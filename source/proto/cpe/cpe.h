@@ -2,19 +2,107 @@
 #define CPE_H
 #include <stdint.h>
 #include <stddef.h>
+#include <tinycrypt/aes.h>
+#include <tinycrypt/ccm_mode.h>
+#include <tinycrypt/cmac_mode.h>
+#include <tinycrypt/ctr_mode.h>
+
+/* ---------------- Schéma de mesure ------- */
+/* Source unique de la mesure : X(nom, octets, type C, échelle).
+ * Le type C fixe la signe, l'échelle est le diviseur vers l'unité
+ * physique. Champs big-endian, dans l'ordre, sur le fil. La structure,
+ * les offsets, CPE_MEASURE_LEN, pack / unpack, les accesseurs de vue et
+ * le décodeur de la passerelle en sont générés à la compilation.
+ * Ajouter un capteur = ajouter une ligne (largeur 1, 2 ou 4).          */
+#define CPE_MEASURE_FIELDS(X)                     \
+    X(temperature_centi, 2, int16_t, 100) /* °C */ \
+    X(humidity_centi, 2, uint16_t, 100)   /* %  */ \
+    X(pressure_decihPa, 2, uint16_t, 10)  /* hPa */ \
+    X(lux, 2, int16_t, 1)                 /* lx */
+
+/* offsets : CPE_MOFF_<nom> ; CPE_MEND_<nom> = dernier octet du champ    */
+#define CPE_X_OFFSET(name, width, type, scale) \
+    CPE_MOFF_##name, CPE_MEND_##name = CPE_MOFF_##name + (width) - 1,
+#define CPE_X_COUNT(name, width, type, scale) CPE_MIDX_##name,
+enum
+{
+    CPE_MEASURE_FIELDS(CPE_X_OFFSET)
+    CPE_MEASURE_LEN_
+};
+enum
+{
+    CPE_MEASURE_FIELDS(CPE_X_COUNT)
+    CPE_MEASURE_NFIELDS
+};
 
 /* ---------------- Tailles ---------------- */
-#define CPE_PLAINTEXT_LEN 11 /* 1 type + 1 id + 8 data + 1 pad      */
-#define CPE_PAYLOAD_LEN 12   /* seq (1) + chiffré (11)             */
+#define CPE_MEASURE_LEN ((int)CPE_MEASURE_LEN_)
+#define CPE_PLAINTEXT_LEN (2 + CPE_MEASURE_LEN + 1) /* type, id, data, pad */
+#define CPE_PAYLOAD_LEN (1 + CPE_PLAINTEXT_LEN)     /* seq + chiffré     */
 #define CPE_KEY_LEN 16
 
+/* une trame courte = un seul bloc de keystream */
+typedef char cpe_plaintext_fits_one_block[CPE_PLAINTEXT_LEN <= 16 ? 1 : -1];
+
+/* Trame MEASURE_BATCH : seq (1) + chiffré [type, id, n, t0 (4),
+ * n x (dt (2) + mesure (8))] ; bornée par radio_max_packet_size        */
+#define CPE_BATCH_HDR_LEN 7
+#define CPE_BATCH_SAMPLE_LEN (2 + CPE_MEASURE_LEN)
+#define CPE_BATCH_MAX_LEN 248
+#define CPE_BATCH_LEN(n) (1 + CPE_BATCH_HDR_LEN + (n) * CPE_BATCH_SAMPLE_LEN)
+#define CPE_BATCH_MAX_SAMPLES \
+    ((CPE_BATCH_MAX_LEN - 1 - CPE_BATCH_HDR_LEN) / CPE_BATCH_SAMPLE_LEN)
+
+/* Série compressée : n (1) + t0 (4) + 1re mesure absolue (8), puis par
+ * échantillon un masque (1) et des varints zig-zag pour les valeurs non
+ * nulles : delta-of-delta du temps, delta de T, H, P et L.             */
+#define CPE_SERIES_HDR_LEN (1 + 4 + CPE_MEASURE_LEN)
+#define CPE_SERIES_MAX_SAMPLES 64
+
+/* Trame MEASURE_MULTI : une mesure par point de mesure d'un même nœud,
+ * seq (1) + chiffré [type, id, n, n x (point (1) + mesure (8))]         */
+#define CPE_MULTI_HDR_LEN 3
+#define CPE_MULTI_POINT_LEN (1 + CPE_MEASURE_LEN)
+#define CPE_MULTI_LEN(n) (1 + CPE_MULTI_HDR_LEN + (n) * CPE_MULTI_POINT_LEN)
+#define CPE_MULTI_MAX_POINTS 8
+
+/* Authentification : tag AES-CMAC tronqué ajouté après le chiffré     */
+#define CPE_AUTH_TAG_LEN 4
+#define CPE_AUTH_PAYLOAD_LEN (CPE_PAYLOAD_LEN + CPE_AUTH_TAG_LEN)
+
+/* AEAD : trame AES-CCM = seq (1) + chiffré (11) + tag (4), même taille
+ * qu'une trame scellée ; nonce 0..0 | seq, clé de trame (pas de clé MAC) */
+#define CPE_CCM_TAG_LEN 4
+#define CPE_CCM_PAYLOAD_LEN (CPE_PAYLOAD_LEN + CPE_CCM_TAG_LEN)
+
+/* Nombre de blocs de keystream précalculés (un par numéro de séquence) */
+#ifndef CPE_KS_POOL_LEN
+#define CPE_KS_POOL_LEN 16
+#endif
+
 /* ---------------- Types de trame --------- */
 typedef enum
 {
     CPE_FT_MEASURE = 0x01,
-    CPE_FT_CONTROL = 0x02
+    CPE_FT_CONTROL = 0x02,
+    CPE_FT_MEASURE_BATCH = 0x03,
+    CPE_FT_MEASURE_SERIES = 0x04,
+    CPE_FT_PROFILE = 0x05, /* trame courte, p[2] = cpe_profile_t */
+    CPE_FT_MEASURE_MULTI = 0x06
 } cpe_frame_type_t;
 
+/* ---------------- Profils de mesure ------ */
+/* Réglage BME280 (suréchantillonnage, mode, filtre) choisi à distance ;
+ * mêmes valeurs que BME280_PROFILE_* côté driver                       */
+typedef enum
+{
+    CPE_PROFILE_WEATHER = 0,       /* forcé x1, 1 Hz, sans filtre     */
+    CPE_PROFILE_INDOOR = 1,        /* P x16, filtre 16, bruit minimal */
+    CPE_PROFILE_FAST_RESPONSE = 2, /* P x4, filtre 2, réactif         */
+    CPE_PROFILE_LOW_POWER = 3,     /* normal x1, veille 1 s           */
+    CPE_PROFILE_COUNT
+} cpe_profile_t;
+
 /* ---------------- Codage ordre OLED ------ */
 typedef enum
 {
@@ -40,14 +128,149 @@ static inline void cpe_ctrl_unpack(uint8_t c, cpe_sensor_t o[4])
 }
 
 /* ---------------- Mesures brutes --------- */
+#define CPE_X_MEMBER(name, width, type, scale) type name;
 typedef struct
 {
-    int16_t temperature_centi;
-    uint16_t humidity_centi;
-    uint16_t pressure_decihPa;
-    int16_t lux;
+    CPE_MEASURE_FIELDS(CPE_X_MEMBER)
 } cpe_measure_t;
 
+/* big-endian sur width octets ; width est constant à chaque appel
+ * généré, la boucle est déroulée et sans branche                      */
+static inline uint32_t cpe_be_get(const uint8_t *p, unsigned width)
+{
+    uint32_t v = 0;
+    for (unsigned i = 0; i < width; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+static inline void cpe_be_put(uint8_t *p, uint32_t v, unsigned width)
+{
+    for (unsigned i = width; i-- > 0; v >>= 8)
+        p[i] = (uint8_t)v;
+}
+
+#define CPE_X_PUT(name, width, type, scale) \
+    cpe_be_put(p + CPE_MOFF_##name, (uint32_t)m->name, width);
+#define CPE_X_GET(name, width, type, scale) \
+    m->name = (type)cpe_be_get(p + CPE_MOFF_##name, width);
+
+static inline void cpe_measure_pack(const cpe_measure_t *m,
+                                    uint8_t p[CPE_MEASURE_LEN])
+{
+    CPE_MEASURE_FIELDS(CPE_X_PUT)
+}
+static inline void cpe_measure_unpack(const uint8_t p[CPE_MEASURE_LEN],
+                                      cpe_measure_t *m)
+{
+    CPE_MEASURE_FIELDS(CPE_X_GET)
+}
+
+/* Mesure horodatée (ms depuis le boot) pour les trames MEASURE_BATCH   */
+typedef struct
+{
+    uint32_t t_ms;
+    cpe_measure_t m;
+} cpe_sample_t;
+
+/* Point de mesure : capteurs ayant fourni la mesure, par rang de
+ * découverte sur le bus (CPE_POINT_NONE : champs correspondants à 0)   */
+#define CPE_POINT_NONE 0x0F
+static inline uint8_t cpe_point_pack(uint8_t env, uint8_t light)
+{
+    return (uint8_t)(((env & 0x0FU) << 4) | (light & 0x0FU));
+}
+static inline uint8_t cpe_point_env(uint8_t point) /* BME280 : T, H, P */
+{
+    return point >> 4;
+}
+static inline uint8_t cpe_point_light(uint8_t point) /* TSL256x : lux */
+{
+    return point & 0x0FU;
+}
+
+typedef struct
+{
+    uint8_t point;
+    cpe_measure_t m;
+} cpe_point_t;
+
+/* ---------------- Vue sur trame ---------- */
+/* Trame déchiffrée en place (cpe_open_frame) : p pointe sur le clair
+ * [type, id, ...] dans le buffer de l'appelant, rien n'est copié. La vue
+ * reste valide tant que ce buffer vit.                                  */
+typedef struct
+{
+    const uint8_t *p;
+    size_t len; /* longueur du clair */
+} cpe_view_t;
+
+static inline cpe_frame_type_t cpe_view_type(const cpe_view_t *v)
+{
+    return (cpe_frame_type_t)v->p[0];
+}
+static inline uint8_t cpe_view_device_id(const cpe_view_t *v)
+{
+    return v->p[1];
+}
+/* CPE_FT_CONTROL */
+static inline uint8_t cpe_view_ctrl(const cpe_view_t *v)
+{
+    return v->p[2];
+}
+/* CPE_FT_PROFILE : à valider contre CPE_PROFILE_COUNT */
+static inline uint8_t cpe_view_profile(const cpe_view_t *v)
+{
+    return v->p[2];
+}
+/* CPE_FT_MEASURE : cpe_view_<nom>() pour chaque champ du schéma */
+#define CPE_X_VIEW(name, width, type, scale)                             \
+    static inline type cpe_view_##name(const cpe_view_t *v)              \
+    {                                                                    \
+        return (type)cpe_be_get(v->p + 2 + CPE_MOFF_##name, width);      \
+    }
+CPE_MEASURE_FIELDS(CPE_X_VIEW)
+/* CPE_FT_MEASURE_BATCH / SERIES / MULTI : n est au même offset */
+static inline uint8_t cpe_view_sample_count(const cpe_view_t *v)
+{
+    return v->p[2];
+}
+
+/* ---------------- Contexte --------------- */
+/* État lié à une clé : schedule AES, CMAC (sous-clés) et pool de
+ * keystream. L'API globale utilise un contexte interne ; les fonctions
+ * cpe_ctx_* servent aux usages multi-clés / multi-threads (passerelle).
+ * Non copiable : cmac.sched pointe sur mac_sched.                       */
+typedef struct
+{
+    uint8_t valid;
+    uint8_t seq;
+    uint8_t ks[CPE_PLAINTEXT_LEN];
+} cpe_ks_slot_t;
+
+typedef struct
+{
+    struct tc_aes_key_sched_struct sched;
+    struct tc_aes_key_sched_struct mac_sched;
+    struct tc_cmac_struct cmac;
+    cpe_ks_slot_t pool[CPE_KS_POOL_LEN];
+} cpe_ctx_t;
+
+/* ---------------- MAC incrémental -------- */
+/* CMAC sous la clé MAC du contexte, alimenté par fragments (ex. vidage
+ * d'historique) sans bufferiser le message. Le schedule et les sous-clés
+ * K1/K2 restent ceux du contexte, calculés une fois par cpe_ctx_init :
+ * démarrer un MAC ne coûte qu'une copie d'état, aucun bloc AES.        */
+typedef struct
+{
+    struct tc_cmac_struct st;
+} cpe_mac_t;
+
+/* ---------------- CTR en flux ------------ */
+/* Chiffrement par morceaux d'une trame longue (domaine d'IV des trames
+ * BATCH / SERIES) : le bloc de keystream entamé est conservé entre les
+ * appels, chaque bloc AES n'est calculé qu'une fois.                  */
+typedef struct tc_ctr_stream_struct cpe_stream_t;
+
 /* ---------------- API -------------------- */
 #ifdef __cplusplus
 extern "C"
@@ -55,6 +278,18 @@ extern "C"
 #endif
     void cpe_init(const uint8_t key[CPE_KEY_LEN]);
 
+    /* clé propre à un device : K_dev = AES_Kmaître("CPE-DEV" 0.. | dev).
+     * La variante _sched réutilise un schedule maître déjà étendu.      */
+    void cpe_derive_device_key(const uint8_t master_key[CPE_KEY_LEN],
+                               uint8_t device_id, uint8_t key_out[CPE_KEY_LEN]);
+    void cpe_derive_device_key_sched(const struct tc_aes_key_sched_struct *master,
+                                     uint8_t device_id, uint8_t key_out[CPE_KEY_LEN]);
+
+    /* précalcule le keystream des CPE_KS_POOL_LEN séquences à partir de
+     * next_seq (à appeler en temps libre) ; retourne le nb de blocs AES
+     * effectivement calculés                                               */
+    int cpe_ks_refill(uint8_t next_seq);
+
     void cpe_build_measure_frame(const cpe_measure_t *m,
                                  uint8_t device_id,
                                  uint8_t seq,
@@ -65,13 +300,189 @@ extern "C"
                                  uint8_t seq,
                                  uint8_t out_frame[CPE_PAYLOAD_LEN]);
 
-    /* parse : remplit selon le type                                         */
+    /* demande de changement de profil de mesure (cpe_profile_t)           */
+    void cpe_build_profile_frame(uint8_t profile,
+                                 uint8_t device_id,
+                                 uint8_t seq,
+                                 uint8_t out_frame[CPE_PAYLOAD_LEN]);
+
+    /* parse : remplit selon le type ; ctrl_out reçoit l'ordre OLED
+     * (CONTROL) ou le profil (PROFILE)                                     */
     int cpe_parse_frame(const uint8_t frame[CPE_PAYLOAD_LEN],
                         cpe_frame_type_t *type_out,
                         uint8_t *dev_id_out,
                         cpe_measure_t *meas_out, /* NULL si pas utile   */
                         uint8_t *ctrl_out);      /* NULL si pas utile   */
 
+    /* batch : n échantillons (t_ms croissants, écarts <= 65535 ms) dans une
+     * seule trame chiffrée ; retourne la longueur écrite ou -1             */
+    int cpe_build_measure_batch(const cpe_sample_t *samples,
+                                uint8_t n,
+                                uint8_t device_id,
+                                uint8_t seq,
+                                uint8_t *out_frame,
+                                size_t out_len);
+
+    /* multi-points : n mesures prises au même instant par différents
+     * capteurs du nœud ; retourne la longueur écrite ou -1                 */
+    int cpe_build_multi_frame(const cpe_point_t *points,
+                              uint8_t n,
+                              uint8_t device_id,
+                              uint8_t seq,
+                              uint8_t *out_frame,
+                              size_t out_len);
+
+    /* retourne le nb de points décodés (<= max) ou -1                      */
+    int cpe_parse_multi_frame(const uint8_t *frame,
+                              size_t len,
+                              uint8_t *dev_id_out,
+                              cpe_point_t *points_out,
+                              uint8_t max);
+
+    /* série compressée (delta / varint), sans chiffrement ; retourne la
+     * longueur écrite, ou -1 si n > CPE_SERIES_MAX_SAMPLES / out trop petit */
+    int cpe_series_encode(const cpe_sample_t *samples,
+                          uint8_t n,
+                          uint8_t *out,
+                          size_t out_len);
+
+    /* retourne le nb d'échantillons décodés (<= max) ou -1                 */
+    int cpe_series_decode(const uint8_t *in,
+                          size_t len,
+                          cpe_sample_t *samples_out,
+                          uint8_t max);
+
+    /* trame MEASURE_SERIES : comme MEASURE_BATCH, corps compressé         */
+    int cpe_build_series_frame(const cpe_sample_t *samples,
+                               uint8_t n,
+                               uint8_t device_id,
+                               uint8_t seq,
+                               uint8_t *out_frame,
+                               size_t out_len);
+
+    /* ajoute le tag CMAC tronqué à une trame déjà construite (seq + chiffré,
+     * tout type) ; retourne la nouvelle longueur ou -1 si out_len trop petit */
+    int cpe_auth_seal(uint8_t *frame, size_t len, size_t out_len);
+
+    /* vérifie le tag en temps constant, avant tout déchiffrement ; retourne
+     * la longueur de la trame interne (à passer aux parseurs) ou -1         */
+    int cpe_auth_check(const uint8_t *frame, size_t len);
+
+    /* MAC incrémental : begin, update (autant de fois que nécessaire),
+     * puis final ou verify (tag tronqué à tag_len <= 16 octets)           */
+    void cpe_mac_begin(cpe_mac_t *mac);
+    int cpe_mac_update(cpe_mac_t *mac, const uint8_t *data, size_t len);
+    void cpe_mac_final(cpe_mac_t *mac, uint8_t *tag, size_t tag_len);
+    /* comparaison en temps constant ; retourne 0 si le tag est valide    */
+    int cpe_mac_verify(cpe_mac_t *mac, const uint8_t *tag, size_t tag_len);
+
+    /* CTR en flux pour la trame longue de numéro seq : begin, puis crypt
+     * en place sur des morceaux consécutifs de taille quelconque.
+     * Le résultat est identique au chiffrement de la trame d'un seul tenant.
+     * Retourne 0 ou -1.                                                   */
+    void cpe_stream_begin(cpe_stream_t *stream, uint8_t seq);
+    int cpe_stream_crypt(cpe_stream_t *stream, uint8_t *buf, size_t len);
+
+    /* MEASURE / CONTROL / PROFILE chiffrés et authentifiés en une
+     * opération CCM                                                       */
+    void cpe_ccm_build_measure_frame(const cpe_measure_t *m,
+                                     uint8_t device_id,
+                                     uint8_t seq,
+                                     uint8_t out_frame[CPE_CCM_PAYLOAD_LEN]);
+
+    void cpe_ccm_build_control_frame(uint8_t ctrl_byte,
+                                     uint8_t device_id,
+                                     uint8_t seq,
+                                     uint8_t out_frame[CPE_CCM_PAYLOAD_LEN]);
+
+    void cpe_ccm_build_profile_frame(uint8_t profile,
+                                     uint8_t device_id,
+                                     uint8_t seq,
+                                     uint8_t out_frame[CPE_CCM_PAYLOAD_LEN]);
+
+    /* vérifie le tag et déchiffre en place (comme cpe_open_frame) ; en cas
+     * d'échec retourne -1 et le clair est effacé                          */
+    int cpe_ccm_open_frame(uint8_t *frame, size_t len, cpe_view_t *view);
+
+    /* décode MEASURE_BATCH et MEASURE_SERIES ; retourne le nb
+     * d'échantillons décodés (<= max) ou -1                                */
+    int cpe_parse_measure_batch(const uint8_t *frame,
+                                size_t len,
+                                uint8_t *dev_id_out,
+                                cpe_sample_t *samples_out,
+                                uint8_t max);
+
+    /* déchiffre en place frame[1..len[ (12 octets ou trame longue, tag déjà
+     * retiré par cpe_auth_check) et vérifie type / longueur ; retourne 0 et
+     * remplit la vue, ou -1. Le buffer ne contient plus le chiffré ensuite. */
+    int cpe_open_frame(uint8_t *frame, size_t len, cpe_view_t *view);
+
+    /* échantillons d'une vue MEASURE_BATCH / MEASURE_SERIES ; retourne le
+     * nb d'échantillons décodés (<= max) ou -1                             */
+    int cpe_view_samples(const cpe_view_t *view, cpe_sample_t *samples_out,
+                         uint8_t max);
+
+    /* points d'une vue MEASURE_MULTI ; retourne le nb de points décodés
+     * (<= max) ou -1                                                       */
+    int cpe_view_points(const cpe_view_t *view, cpe_point_t *points_out,
+                        uint8_t max);
+
+    /* ---- Variantes à contexte explicite (réentrantes) ----
+     * Seuls cpe_ctx_init et cpe_ctx_ks_refill modifient le contexte ; les
+     * autres peuvent être appelées en parallèle sur un même contexte.     */
+    void cpe_ctx_init(cpe_ctx_t *ctx, const uint8_t key[CPE_KEY_LEN]);
+    int cpe_ctx_ks_refill(cpe_ctx_t *ctx, uint8_t next_seq);
+    void cpe_ctx_build_measure_frame(const cpe_ctx_t *ctx, const cpe_measure_t *m,
+                                     uint8_t device_id, uint8_t seq,
+                                     uint8_t out_frame[CPE_PAYLOAD_LEN]);
+    void cpe_ctx_build_control_frame(const cpe_ctx_t *ctx, uint8_t ctrl_byte,
+                                     uint8_t device_id, uint8_t seq,
+                                     uint8_t out_frame[CPE_PAYLOAD_LEN]);
+    void cpe_ctx_build_profile_frame(const cpe_ctx_t *ctx, uint8_t profile,
+                                     uint8_t device_id, uint8_t seq,
+                                     uint8_t out_frame[CPE_PAYLOAD_LEN]);
+    int cpe_ctx_parse_frame(const cpe_ctx_t *ctx,
+                            const uint8_t frame[CPE_PAYLOAD_LEN],
+                            cpe_frame_type_t *type_out, uint8_t *dev_id_out,
+                            cpe_measure_t *meas_out, uint8_t *ctrl_out);
+    int cpe_ctx_build_measure_batch(const cpe_ctx_t *ctx,
+                                    const cpe_sample_t *samples, uint8_t n,
+                                    uint8_t device_id, uint8_t seq,
+                                    uint8_t *out_frame, size_t out_len);
+    int cpe_ctx_build_series_frame(const cpe_ctx_t *ctx,
+                                   const cpe_sample_t *samples, uint8_t n,
+                                   uint8_t device_id, uint8_t seq,
+                                   uint8_t *out_frame, size_t out_len);
+    int cpe_ctx_parse_measure_batch(const cpe_ctx_t *ctx, const uint8_t *frame,
+                                    size_t len, uint8_t *dev_id_out,
+                                    cpe_sample_t *samples_out, uint8_t max);
+    int cpe_ctx_build_multi_frame(const cpe_ctx_t *ctx, const cpe_point_t *points,
+                                  uint8_t n, uint8_t device_id, uint8_t seq,
+                                  uint8_t *out_frame, size_t out_len);
+    int cpe_ctx_parse_multi_frame(const cpe_ctx_t *ctx, const uint8_t *frame,
+                                  size_t len, uint8_t *dev_id_out,
+                                  cpe_point_t *points_out, uint8_t max);
+    int cpe_ctx_open_frame(const cpe_ctx_t *ctx, uint8_t *frame, size_t len,
+                           cpe_view_t *view);
+    void cpe_ctx_ccm_build_measure_frame(const cpe_ctx_t *ctx, const cpe_measure_t *m,
+                                         uint8_t device_id, uint8_t seq,
+                                         uint8_t out_frame[CPE_CCM_PAYLOAD_LEN]);
+    void cpe_ctx_ccm_build_control_frame(const cpe_ctx_t *ctx, uint8_t ctrl_byte,
+                                         uint8_t device_id, uint8_t seq,
+                                         uint8_t out_frame[CPE_CCM_PAYLOAD_LEN]);
+    void cpe_ctx_ccm_build_profile_frame(const cpe_ctx_t *ctx, uint8_t profile,
+                                         uint8_t device_id, uint8_t seq,
+                                         uint8_t out_frame[CPE_CCM_PAYLOAD_LEN]);
+    int cpe_ctx_ccm_open_frame(const cpe_ctx_t *ctx, uint8_t *frame, size_t len,
+                               cpe_view_t *view);
+    void cpe_ctx_stream_begin(const cpe_ctx_t *ctx, cpe_stream_t *stream,
+                              uint8_t seq);
+    void cpe_ctx_mac_begin(const cpe_ctx_t *ctx, cpe_mac_t *mac);
+    int cpe_ctx_auth_seal(const cpe_ctx_t *ctx, uint8_t *frame, size_t len,
+                          size_t out_len);
+    int cpe_ctx_auth_check(const cpe_ctx_t *ctx, const uint8_t *frame,
+                           size_t len);
+
 #ifdef __cplusplus
 }
 #endif